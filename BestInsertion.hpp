@@ -0,0 +1,245 @@
+#ifndef FILO__BESTINSERTION_HPP_
+#define FILO__BESTINSERTION_HPP_
+
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "CostTable.hpp"
+#include "FlatRoutes.hpp"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Cheapest insertion of a single customer into the routes of a solution.
+// Each route is gathered into contiguous buffers once, so that the insertion deltas of all its positions can be
+// evaluated in a tight loop (AVX2 when available) without walking the linked lists of the solution.
+// When flat routes are enabled, the gathered routes are also kept across calls until invalidated, so that reinserting
+// several customers walks each route once. Callers must then invalidate the routes they modify, see FlatRoutes.
+class BestInsertion {
+
+ public:
+
+    struct Position {
+        int route = cobra::Solution::dummy_route;
+        int where = cobra::Solution::dummy_vertex;
+        float delta = std::numeric_limits<float>::max();
+    };
+
+ private:
+
+    const cobra::Instance& instance;
+    const CostTable& costs;
+
+    // sequence[k] is the k-th vertex of the route being evaluated, with the depot both at 0 and at route size + 1
+    std::vector<int> sequence;
+    // arc_costs[k] is the cost of the arc (sequence[k - 1], sequence[k])
+    std::vector<float> arc_costs;
+    // customer_costs[k] is the cost of the arc (customer, sequence[k])
+    std::vector<float> customer_costs;
+
+    const bool use_flat_routes;
+    FlatRoutes flat_routes;
+
+    // insertion positions evaluated so far, for profiling
+    unsigned long evaluated_positions = 0;
+
+ public:
+
+    BestInsertion(const cobra::Instance& instance_, const CostTable& costs_, bool use_flat_routes_ = false) : instance(instance_),
+                                                               costs(costs_),
+                                                               sequence(instance.get_vertices_num() + 1),
+                                                               arc_costs(instance.get_vertices_num() + 1),
+                                                               customer_costs(instance.get_vertices_num() + 1),
+                                                               use_flat_routes(use_flat_routes_),
+                                                               flat_routes(instance_, costs_) { }
+
+    // Marks every route as modified, to be called whenever the solution has been changed by someone else.
+    void invalidate() {
+        flat_routes.invalidate();
+    }
+
+    // Marks route as modified, e.g. after inserting a customer at the position returned by find_best.
+    void invalidate(int route) {
+        flat_routes.invalidate(route);
+    }
+
+    unsigned long get_evaluated_positions() const {
+        return evaluated_positions;
+    }
+
+    // Best feasible position over all routes. The returned route is dummy_route if no route can host the customer.
+    Position find_best(const cobra::Solution& solution, int customer) {
+
+        auto best = Position();
+
+        for (auto route = solution.get_first_route(); route != cobra::Solution::dummy_route; route = solution.get_next_route(route)) {
+
+            if (solution.get_route_load(route) + instance.get_demand(customer) > instance.get_vehicle_capacity()) { continue; }
+
+            evaluate_route(solution, route, customer, best);
+
+        }
+
+        return best;
+
+    }
+
+    // Best feasible position before or after one of the first neighbors_num neighbors of the customer which are in solution.
+    // The returned route is dummy_route if none of those routes can host the customer.
+    Position find_best_among_neighbors(const cobra::Solution& solution, int customer, int neighbors_num) {
+
+        auto best = Position();
+
+        const auto& neighbors = instance.get_neighbors_of(customer);
+        const auto max_n = std::min(static_cast<int>(neighbors.size()), neighbors_num + 1);
+
+        for (auto n = 1; n < max_n; n++) {
+
+            const auto vertex = neighbors[n];
+
+            if (vertex == instance.get_depot() || !solution.is_customer_in_solution(vertex)) { continue; }
+
+            const auto route = solution.get_route_index(vertex);
+
+            if (solution.get_route_load(route) + instance.get_demand(customer) > instance.get_vehicle_capacity()) { continue; }
+
+            auto prev = cobra::Solution::dummy_vertex;
+            auto next = cobra::Solution::dummy_vertex;
+            auto prev_arc_cost = 0.0f;
+            auto next_arc_cost = 0.0f;
+
+            if (use_flat_routes && flat_routes.is_valid(route)) {
+                const auto& flat = flat_routes.get(solution, route);
+                const auto position = flat_routes.get_position(vertex);
+                prev = flat.vertices[position - 1];
+                next = flat.vertices[position + 1];
+                prev_arc_cost = flat.arc_costs[position];
+                next_arc_cost = flat.arc_costs[position + 1];
+            } else {
+                prev = solution.get_prev_vertex(vertex);
+                next = solution.get_next_vertex(vertex);
+                prev_arc_cost = costs.get_cost(prev, vertex);
+                next_arc_cost = costs.get_cost(vertex, next);
+            }
+
+            const auto customer_vertex_cost = costs.get_neighbor_cost(customer, n);
+            evaluated_positions += 2;
+
+            const auto delta_before = -prev_arc_cost + costs.get_cost(prev, customer) + customer_vertex_cost;
+
+            if (delta_before < best.delta) {
+                best = {route, vertex, delta_before};
+            }
+
+            const auto delta_after = -next_arc_cost + customer_vertex_cost + costs.get_cost(customer, next);
+
+            if (delta_after < best.delta) {
+                best = {route, next, delta_after};
+            }
+
+        }
+
+        return best;
+
+    }
+
+ private:
+
+    // Updates best if a strictly better position is found in route. Ties are broken in favour of the earliest position,
+    // i.e. the outcome is the same as scanning the positions one by one.
+    void evaluate_route(const cobra::Solution& solution, int route, int customer, Position& best) {
+
+        const auto depot = instance.get_depot();
+
+        auto size = 0;
+        const int* vertices = nullptr;
+        const float* route_arc_costs = nullptr;
+
+        if (use_flat_routes) {
+
+            const auto& flat = flat_routes.get(solution, route);
+            size = static_cast<int>(flat.vertices.size()) - 2;
+            vertices = flat.vertices.data();
+            route_arc_costs = flat.arc_costs.data();
+
+        } else {
+
+            sequence[0] = depot;
+            for (auto curr = solution.get_first_customer(route); curr != depot; curr = solution.get_next_vertex(curr)) {
+                size++;
+                sequence[size] = curr;
+                arc_costs[size] = costs.get_cost(sequence[size - 1], curr);
+            }
+            sequence[size + 1] = depot;
+            arc_costs[size + 1] = costs.get_cost(sequence[size], depot);
+            vertices = sequence.data();
+            route_arc_costs = arc_costs.data();
+
+        }
+
+        costs.get_costs(customer, vertices, size + 2, customer_costs.data());
+
+        // inserting before vertices[p + 1] costs prev[p] - arcs[p] + next[p], for p in [0, positions)
+        const auto positions = size + 1;
+        evaluated_positions += positions;
+        const auto prev = customer_costs.data();
+        const auto arcs = route_arc_costs + 1;
+        const auto next = customer_costs.data() + 1;
+
+        auto route_best_delta = std::numeric_limits<float>::max();
+        auto route_best_p = -1;
+
+        auto p = 0;
+
+        #ifdef __AVX2__
+        if (positions >= 8) {
+
+            auto min_deltas = _mm256_set1_ps(std::numeric_limits<float>::max());
+            auto min_indices = _mm256_set1_epi32(-1);
+            auto indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const auto step = _mm256_set1_epi32(8);
+
+            for (; p + 8 <= positions; p += 8) {
+                const auto deltas = _mm256_add_ps(_mm256_sub_ps(_mm256_loadu_ps(prev + p), _mm256_loadu_ps(arcs + p)), _mm256_loadu_ps(next + p));
+                const auto improving = _mm256_cmp_ps(deltas, min_deltas, _CMP_LT_OQ);
+                min_deltas = _mm256_blendv_ps(min_deltas, deltas, improving);
+                min_indices = _mm256_blendv_epi8(min_indices, indices, _mm256_castps_si256(improving));
+                indices = _mm256_add_epi32(indices, step);
+            }
+
+            alignas(32) float lane_deltas[8];
+            alignas(32) int lane_indices[8];
+            _mm256_store_ps(lane_deltas, min_deltas);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lane_indices), min_indices);
+
+            for (auto lane = 0; lane < 8; lane++) {
+                if (lane_indices[lane] < 0) { continue; }
+                if (lane_deltas[lane] < route_best_delta || (lane_deltas[lane] == route_best_delta && lane_indices[lane] < route_best_p)) {
+                    route_best_delta = lane_deltas[lane];
+                    route_best_p = lane_indices[lane];
+                }
+            }
+
+        }
+        #endif
+
+        for (; p < positions; p++) {
+            const auto delta = prev[p] - arcs[p] + next[p];
+            if (delta < route_best_delta) {
+                route_best_delta = delta;
+                route_best_p = p;
+            }
+        }
+
+        if (route_best_delta < best.delta) {
+            best = {route, vertices[route_best_p + 1], route_best_delta};
+        }
+
+    }
+
+};
+
+#endif //FILO__BESTINSERTION_HPP_
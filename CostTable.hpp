@@ -0,0 +1,252 @@
+#ifndef FILO__COSTTABLE_HPP_
+#define FILO__COSTTABLE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cobra/Instance.hpp>
+
+// Arc costs used by the filo hot loops (insertion evaluation and ruin and recreate), with a backend chosen by instance
+// size. Small instances store the full matrix. Large instances store the costs to the depot and to the first neighbors
+// of each vertex, and compute any other cost on the fly from the coordinates. The on-the-fly computation is only used
+// if it reproduces instance.get_cost() exactly on a sample of arcs, otherwise costs are requested to the instance.
+class CostTable {
+
+ public:
+
+    enum class Backend {
+        FULL_MATRIX,
+        SPARSE
+    };
+
+ private:
+
+    const cobra::Instance& instance;
+    const bool round_costs;
+    const int vertices_num;
+
+    Backend backend;
+
+    // FULL_MATRIX backend
+    std::vector<float> matrix;
+
+    // SPARSE backend
+    int neighbors_num = 0;
+    std::vector<float> neighbor_costs;
+    std::vector<float> depot_costs;
+    std::vector<float> x_coordinates;
+    std::vector<float> y_coordinates;
+    bool euclidean = false;
+
+    // Rows and columns of the matrix filled together, as in mean_arc_cost::compute.
+    static constexpr auto block_size = 256;
+
+    // Fills the upper triangle of the matrix by blocks of rows, distributed dynamically among threads_num threads, and
+    // mirrors each cost in the lower triangle. Blocks write disjoint cells: the block holding row i writes the cells
+    // (i, j) and (j, i) for j >= i only.
+    void fill_matrix(int threads_num) {
+
+        matrix.resize(static_cast<size_t>(vertices_num) * vertices_num);
+
+        const auto blocks_num = (vertices_num + block_size - 1) / block_size;
+
+        if (threads_num <= 0) {
+            threads_num = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads_num = std::min(threads_num, blocks_num);
+
+        auto next_block = std::atomic<int>(0);
+
+        const auto worker = [&]() {
+            for (auto block = next_block++; block < blocks_num; block = next_block++) {
+                const auto i_begin = block * block_size;
+                const auto i_end = std::min(i_begin + block_size, vertices_num);
+                for (auto j_begin = i_begin; j_begin < vertices_num; j_begin += block_size) {
+                    const auto j_end = std::min(j_begin + block_size, vertices_num);
+                    for (auto i = i_begin; i < i_end; i++) {
+                        for (auto j = std::max(i, j_begin); j < j_end; j++) {
+                            const auto cost = instance.get_cost(i, j);
+                            matrix[static_cast<size_t>(i) * vertices_num + j] = cost;
+                            matrix[static_cast<size_t>(j) * vertices_num + i] = cost;
+                        }
+                    }
+                }
+            }
+        };
+
+        auto threads = std::vector<std::thread>();
+        for (auto t = 1; t < threads_num; t++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+    }
+
+    float compute_euclidean(int i, int j) const {
+        const auto dx = x_coordinates[i] - x_coordinates[j];
+        const auto dy = y_coordinates[i] - y_coordinates[j];
+        const auto cost = std::sqrt(dx * dx + dy * dy);
+        return round_costs ? std::round(cost) : cost;
+    }
+
+ public:
+
+    // Uses the full matrix when the instance has at most full_matrix_max_vertices vertices, otherwise the sparse backend
+    // storing the costs to the first neighbors_num_ neighbors of each vertex. The full matrix is filled by threads_num
+    // threads (0 means one per hardware thread).
+    CostTable(const cobra::Instance& instance_, bool round_costs_, int full_matrix_max_vertices, int neighbors_num_, int threads_num = 1) :
+        instance(instance_), round_costs(round_costs_), vertices_num(instance_.get_vertices_num()) {
+
+        if (vertices_num <= full_matrix_max_vertices) {
+            backend = Backend::FULL_MATRIX;
+            fill_matrix(threads_num);
+            return;
+        }
+
+        backend = Backend::SPARSE;
+
+        const auto depot = instance.get_depot();
+
+        neighbors_num = neighbors_num_;
+        neighbor_costs.resize(static_cast<size_t>(vertices_num) * neighbors_num, 0.0f);
+        depot_costs.resize(vertices_num);
+        x_coordinates.resize(vertices_num);
+        y_coordinates.resize(vertices_num);
+
+        for (auto i = 0; i < vertices_num; i++) {
+            depot_costs[i] = instance.get_cost(i, depot);
+            x_coordinates[i] = instance.get_x_coordinate(i);
+            y_coordinates[i] = instance.get_y_coordinate(i);
+            const auto& neighbors = instance.get_neighbors_of(i);
+            const auto max_m = std::min(static_cast<int>(neighbors.size()), neighbors_num);
+            for (auto m = 0; m < max_m; m++) {
+                neighbor_costs[static_cast<size_t>(i) * neighbors_num + m] = instance.get_cost(i, neighbors[m]);
+            }
+        }
+
+        // validate the on-the-fly computation against the neighbor costs and a sample of random arcs
+        euclidean = true;
+        for (auto i = 0; i < vertices_num && euclidean; i++) {
+            const auto& neighbors = instance.get_neighbors_of(i);
+            const auto max_m = std::min(static_cast<int>(neighbors.size()), neighbors_num);
+            for (auto m = 0; m < max_m && euclidean; m++) {
+                euclidean = compute_euclidean(i, neighbors[m]) == neighbor_costs[static_cast<size_t>(i) * neighbors_num + m];
+            }
+        }
+
+        auto rand_engine = std::mt19937(0);
+        auto vertices_distribution = std::uniform_int_distribution<int>(0, vertices_num - 1);
+        for (auto n = 0; n < 10000 && euclidean; n++) {
+            const auto i = vertices_distribution(rand_engine);
+            const auto j = vertices_distribution(rand_engine);
+            euclidean = compute_euclidean(i, j) == instance.get_cost(i, j);
+        }
+
+        if (!euclidean) {
+            x_coordinates = std::vector<float>();
+            y_coordinates = std::vector<float>();
+        }
+
+    }
+
+    // Table on instance_ from the arrays of a table previously built on the same instance with the same parameters,
+    // e.g. stored by neighbor_cache. Coordinates are read again from the instance.
+    CostTable(const cobra::Instance& instance_, bool round_costs_, Backend backend_, int neighbors_num_, std::vector<float> matrix_,
+              std::vector<float> neighbor_costs_, std::vector<float> depot_costs_, bool euclidean_) :
+        instance(instance_), round_costs(round_costs_), vertices_num(instance_.get_vertices_num()), backend(backend_),
+        matrix(std::move(matrix_)), neighbors_num(neighbors_num_), neighbor_costs(std::move(neighbor_costs_)),
+        depot_costs(std::move(depot_costs_)), euclidean(euclidean_) {
+
+        if (euclidean) {
+            x_coordinates.resize(vertices_num);
+            y_coordinates.resize(vertices_num);
+            for (auto i = 0; i < vertices_num; i++) {
+                x_coordinates[i] = instance.get_x_coordinate(i);
+                y_coordinates[i] = instance.get_y_coordinate(i);
+            }
+        }
+
+    }
+
+    Backend get_backend() const { return backend; }
+    int get_neighbors_num() const { return neighbors_num; }
+
+    const std::vector<float>& get_matrix() const { return matrix; }
+    const std::vector<float>& get_neighbor_costs() const { return neighbor_costs; }
+    const std::vector<float>& get_depot_costs() const { return depot_costs; }
+
+    // Whether the sparse backend computes costs on the fly instead of requesting them to the instance.
+    bool is_euclidean() const { return euclidean; }
+
+    size_t get_memory_usage() const {
+        return sizeof(float) * (matrix.capacity() + neighbor_costs.capacity() + depot_costs.capacity() + x_coordinates.capacity() +
+                                y_coordinates.capacity());
+    }
+
+    float get_cost(int i, int j) const {
+        if (backend == Backend::FULL_MATRIX) {
+            return matrix[static_cast<size_t>(i) * vertices_num + j];
+        }
+        if (j == instance.get_depot()) { return depot_costs[i]; }
+        if (i == instance.get_depot()) { return depot_costs[j]; }
+        return euclidean ? compute_euclidean(i, j) : instance.get_cost(i, j);
+    }
+
+    // Cost of the arc between i and its m-th neighbor in instance.get_neighbors_of(i).
+    float get_neighbor_cost(int i, int m) const {
+        if (backend == Backend::SPARSE && m < neighbors_num) {
+            return neighbor_costs[static_cast<size_t>(i) * neighbors_num + m];
+        }
+        return get_cost(i, instance.get_neighbors_of(i)[m]);
+    }
+
+    // Writes in costs[k] the cost of the arc (i, vertices[k]) for k in [0, count). The loop over coordinates of the
+    // sparse backend has no branches and is left to the compiler to vectorize.
+    void get_costs(int i, const int* vertices, int count, float* costs) const {
+
+        if (backend == Backend::FULL_MATRIX) {
+            const auto row = matrix.data() + static_cast<size_t>(i) * vertices_num;
+            for (auto k = 0; k < count; k++) {
+                costs[k] = row[vertices[k]];
+            }
+            return;
+        }
+
+        if (!euclidean) {
+            for (auto k = 0; k < count; k++) {
+                costs[k] = instance.get_cost(i, vertices[k]);
+            }
+            return;
+        }
+
+        const auto x = x_coordinates[i];
+        const auto y = y_coordinates[i];
+        const auto xs = x_coordinates.data();
+        const auto ys = y_coordinates.data();
+
+        if (round_costs) {
+            for (auto k = 0; k < count; k++) {
+                const auto dx = x - xs[vertices[k]];
+                const auto dy = y - ys[vertices[k]];
+                costs[k] = std::round(std::sqrt(dx * dx + dy * dy));
+            }
+        } else {
+            for (auto k = 0; k < count; k++) {
+                const auto dx = x - xs[vertices[k]];
+                const auto dy = y - ys[vertices[k]];
+                costs[k] = std::sqrt(dx * dx + dy * dy);
+            }
+        }
+
+    }
+
+};
+
+#endif //FILO__COSTTABLE_HPP_
@@ -0,0 +1,318 @@
+#ifndef FILO__DECOMPOSITION_HPP_
+#define FILO__DECOMPOSITION_HPP_
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include <cobra/LocalSearch.hpp>
+#include "CostTable.hpp"
+#include "RuinAndRecreate.hpp"
+#include "RouteRestorer.hpp"
+#include "WorkerThreads.hpp"
+
+// Decomposition-based improvement for very large instances. The routes of a solution are partitioned into spatially
+// disjoint clusters (angular sectors of the route barycenters around the depot) and each cluster is re-optimized
+// concurrently by ruin and recreate plus local search on a partial solution containing only its routes. Improved
+// clusters are then merged back into the solution. The threads are started once, by the constructor, and wait for the
+// next decomposition step in between (see WorkerThreads): the calling thread optimizes the first cluster, the others
+// one cluster each.
+class Decomposition {
+
+    // Per-thread optimization engine. The local search handles partial solutions, so that ruin and recreate and local
+    // search moves are confined to the routes of the cluster.
+    class Worker {
+
+     public:
+
+        std::mt19937 rand_engine;
+        cobra::MoveGenerators move_generators;
+        cobra::RandomizedVariableNeighborhoodDescent<true> rvnd0;
+        cobra::RandomizedVariableNeighborhoodDescent<true> rvnd1;
+        cobra::HierarchicalVariableNeighborhoodDescent local_search;
+        RuinAndRecreate rr;
+
+        // routes of the cluster the worker is assigned to during a decomposition step and the partial solution made of them
+        std::vector<int> routes;
+        // customers of those routes, the candidate seeds of ruin and recreate
+        std::vector<int> customers;
+        cobra::Solution partial_solution;
+        cobra::Solution neighbor;
+        // whether the routes of the cluster have been improved during the last decomposition step
+        bool improved = false;
+        // ruin and recreate plus local search iterations run so far
+        long iterations_run = 0;
+
+        // copies the routes touched by a move between partial_solution and neighbor
+        RouteRestorer route_restorer;
+
+        Worker(const cobra::Instance& instance, const CostTable& costs, std::vector<cobra::AbstractMoveGeneratorsView*>& views, int seed, int recreate_neighbors, bool flat_routes,
+               float tolerance, int solution_cache_size, bool round_costs) :
+            rand_engine(seed),
+            move_generators(instance, views),
+            rvnd0(instance, move_generators, {
+                cobra::E11,cobra::E10,cobra::TAILS,cobra::SPLIT,cobra::RE22B,
+                cobra::E22,cobra::RE20,cobra::RE21,cobra::RE22S,cobra::E21,
+                cobra::E20,cobra::TWOPT,cobra::RE30,cobra::E30,cobra::RE33B,
+                cobra::E33,cobra::RE31,cobra::RE32B,cobra::RE33S,cobra::E31,
+                cobra::E32,cobra::RE32S}, rand_engine, tolerance),
+            rvnd1(instance, move_generators, {cobra::EJCH}, rand_engine, tolerance),
+            local_search(tolerance),
+            rr(instance, costs, rand_engine, recreate_neighbors, flat_routes),
+            partial_solution(instance, std::min(instance.get_vertices_num(), solution_cache_size)),
+            neighbor(instance, std::min(instance.get_vertices_num(), solution_cache_size)),
+            route_restorer(instance, std::min(instance.get_vertices_num(), solution_cache_size), round_costs) {
+            local_search.append(&rvnd0);
+            local_search.append(&rvnd1);
+        }
+
+    };
+
+    const cobra::Instance& instance;
+    const float tolerance;
+    const int iterations;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<int> all_vertices;
+
+    // state of the current decomposition step, read by the workers
+    const cobra::Solution* step_solution = nullptr;
+    std::vector<float>* step_gamma = nullptr;
+    const std::vector<int>* step_omega = nullptr;
+
+    long steps = 0;
+    double seconds = 0.0;
+
+    // declared last, so that the threads are stopped before the workers they run are destroyed
+    WorkerThreads worker_threads;
+
+ public:
+
+    Decomposition(const cobra::Instance& instance_, const CostTable& costs, std::vector<cobra::AbstractMoveGeneratorsView*>& views, int threads_num, int iterations_,
+                  int seed, int recreate_neighbors, bool flat_routes, float tolerance_, int solution_cache_size, bool round_costs_) :
+        instance(instance_), tolerance(tolerance_), iterations(iterations_),
+        worker_threads(threads_num, [this](int t) { optimize(*workers[t], *step_solution, *step_gamma, *step_omega); }) {
+
+        for (auto t = 0; t < threads_num; t++) {
+            workers.emplace_back(std::make_unique<Worker>(instance, costs, views, seed + t, recreate_neighbors, flat_routes, tolerance, solution_cache_size,
+                                                          round_costs_));
+        }
+
+        for (auto i = instance.get_vertices_begin(); i < instance.get_vertices_end(); i++) {
+            all_vertices.push_back(i);
+        }
+
+    }
+
+    Decomposition(const Decomposition&) = delete;
+    Decomposition& operator=(const Decomposition&) = delete;
+
+    // Re-optimizes solution cluster by cluster using the current sparsification factors gamma and shaking intensities
+    // omega. Returns whether solution has been improved.
+    bool apply(cobra::Solution& solution, std::vector<float>& gamma, const std::vector<int>& omega) {
+
+        const auto clusters_num = std::min(static_cast<int>(workers.size()), solution.get_routes_num());
+        if (clusters_num < 2) { return false; }
+
+        const auto begin = std::chrono::high_resolution_clock::now();
+
+        partition(solution, clusters_num);
+
+        step_solution = &solution;
+        step_gamma = &gamma;
+        step_omega = &omega;
+        worker_threads.run_step();
+
+        auto improved = false;
+
+        for (auto c = 0; c < clusters_num; c++) {
+
+            if (!workers[c]->improved) { continue; }
+
+            merge(solution, workers[c]->routes, workers[c]->partial_solution);
+            improved = true;
+
+        }
+
+        if (improved) {
+            solution.clear_cache();
+        }
+
+        steps++;
+        seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+        return improved;
+
+    }
+
+    // Decomposition steps run so far and their wall time.
+    long get_steps() const { return steps; }
+    double get_seconds() const { return seconds; }
+
+    // Ruin and recreate plus local search iterations run so far by all the workers, which with perfect scaling grow
+    // linearly with the n. of threads for the same wall time.
+    long get_cluster_iterations() const {
+        auto cluster_iterations = 0l;
+        for (const auto& worker : workers) {
+            cluster_iterations += worker->iterations_run;
+        }
+        return cluster_iterations;
+    }
+
+ private:
+
+    // Splits the routes of solution into clusters_num angular sectors around the depot with roughly the same number of
+    // customers. The sectors start at a random angle so that cluster borders move across decomposition steps.
+    void partition(const cobra::Solution& solution, int clusters_num) {
+
+        const auto depot = instance.get_depot();
+        const auto depot_x = instance.get_x_coordinate(depot);
+        const auto depot_y = instance.get_y_coordinate(depot);
+
+        auto angles = std::vector<std::pair<float, int>>();
+
+        for (auto route = solution.get_first_route(); route != cobra::Solution::dummy_route; route = solution.get_next_route(route)) {
+            auto x = 0.0f;
+            auto y = 0.0f;
+            for (auto curr = solution.get_first_customer(route); curr != depot; curr = solution.get_next_vertex(curr)) {
+                x += instance.get_x_coordinate(curr);
+                y += instance.get_y_coordinate(curr);
+            }
+            const auto size = static_cast<float>(solution.get_route_size(route));
+            angles.emplace_back(std::atan2(y / size - depot_y, x / size - depot_x), route);
+        }
+
+        std::sort(angles.begin(), angles.end());
+
+        const auto offset = std::uniform_int_distribution<int>(0, static_cast<int>(angles.size()) - 1)(workers[0]->rand_engine);
+        std::rotate(angles.begin(), angles.begin() + offset, angles.end());
+
+        for (auto& worker : workers) {
+            worker->routes.clear();
+        }
+
+        const auto customers_per_cluster = static_cast<float>(instance.get_customers_num()) / static_cast<float>(clusters_num);
+        auto customers = 0;
+        for (const auto& [angle, route] : angles) {
+            const auto c = std::min(clusters_num - 1, static_cast<int>(static_cast<float>(customers) / customers_per_cluster));
+            workers[c]->routes.push_back(route);
+            customers += solution.get_route_size(route);
+        }
+
+    }
+
+    // Loop of the thread of workers[t], which optimizes the t-th cluster, if any, at every step.
+    // Makes partial_solution hold the given routes of solution only. The routes it held are removed first, so that the
+    // work is proportional to the size of the clusters, not to that of the solution.
+    void build_partial_solution(cobra::Solution& partial_solution, const cobra::Solution& solution, const std::vector<int>& routes) const {
+
+        for (auto route = partial_solution.get_first_route(); route != cobra::Solution::dummy_route;) {
+            const auto next_route = partial_solution.get_next_route(route);
+            remove_route(partial_solution, route);
+            route = next_route;
+        }
+
+        for (auto route : routes) {
+            const auto first = solution.get_first_customer(route);
+            partial_solution.build_one_customer_route(first);
+            const auto new_route = partial_solution.get_route_index(first);
+            for (auto curr = solution.get_next_vertex(first); curr != instance.get_depot(); curr = solution.get_next_vertex(curr)) {
+                partial_solution.insert_vertex_before(new_route, instance.get_depot(), curr);
+            }
+        }
+
+        partial_solution.clear_cache();
+
+    }
+
+    // Runs a descent of ruin and recreate plus local search on the partial solution made of the routes of the worker's
+    // cluster. Moves are undone, or applied to the partial solution, by copying the routes they touched when the cache
+    // of the neighbor recorded all of them, and by copying the whole solution otherwise.
+    void optimize(Worker& worker, const cobra::Solution& solution, std::vector<float>& gamma, const std::vector<int>& omega) {
+
+        worker.improved = false;
+
+        if (worker.routes.empty()) { return; }
+
+        worker.move_generators.set_active_percentage(gamma, all_vertices);
+
+        auto& customers = worker.customers;
+        customers.clear();
+        for (auto route : worker.routes) {
+            for (auto curr = solution.get_first_customer(route); curr != instance.get_depot(); curr = solution.get_next_vertex(curr)) {
+                customers.push_back(curr);
+            }
+        }
+
+        auto& partial_solution = worker.partial_solution;
+        auto& neighbor = worker.neighbor;
+
+        build_partial_solution(partial_solution, solution, worker.routes);
+        build_partial_solution(neighbor, solution, worker.routes);
+
+        auto customers_distribution = std::uniform_int_distribution<int>(0, static_cast<int>(customers.size()) - 1);
+
+        for (auto iter = 0; iter < iterations; iter++) {
+
+            worker.rr.apply(neighbor, omega, customers[customers_distribution(worker.rand_engine)]);
+            worker.local_search.apply(neighbor);
+
+            const auto improved = neighbor.get_cost() < partial_solution.get_cost() - tolerance;
+            const auto restore_routes = worker.route_restorer.is_complete(neighbor.get_cache());
+
+            if (improved) {
+                if (restore_routes) {
+                    worker.route_restorer.restore(partial_solution, neighbor, neighbor.get_cache());
+                } else {
+                    partial_solution = neighbor;
+                    partial_solution.clear_cache();
+                }
+                neighbor.clear_cache();
+                worker.improved = true;
+            } else if (restore_routes) {
+                worker.route_restorer.restore(neighbor, partial_solution, neighbor.get_cache());
+            } else {
+                neighbor = partial_solution;
+            }
+
+        }
+
+        worker.iterations_run += iterations;
+
+    }
+
+    // Replaces the given routes of solution with the routes of partial_solution.
+    void merge(cobra::Solution& solution, const std::vector<int>& routes, const cobra::Solution& partial_solution) {
+
+        for (auto route : routes) {
+            remove_route(solution, route);
+        }
+
+        for (auto route = partial_solution.get_first_route(); route != cobra::Solution::dummy_route; route = partial_solution.get_next_route(route)) {
+            const auto first = partial_solution.get_first_customer(route);
+            solution.build_one_customer_route(first);
+            const auto new_route = solution.get_route_index(first);
+            for (auto curr = partial_solution.get_next_vertex(first); curr != instance.get_depot(); curr = partial_solution.get_next_vertex(curr)) {
+                solution.insert_vertex_before(new_route, instance.get_depot(), curr);
+            }
+        }
+
+    }
+
+    void remove_route(cobra::Solution& solution, int route) const {
+        auto curr = solution.get_first_customer(route);
+        do {
+            const auto next = solution.get_next_vertex(curr);
+            solution.remove_vertex(route, curr);
+            curr = next;
+        } while (curr != instance.get_depot());
+        solution.remove_route(route);
+    }
+
+};
+
+#endif //FILO__DECOMPOSITION_HPP_
@@ -0,0 +1,100 @@
+#ifndef FILO__FLATROUTES_HPP_
+#define FILO__FLATROUTES_HPP_
+
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <vector>
+#include "CostTable.hpp"
+
+// Contiguous copy of the routes of a solution, so that hot loops read a route sequentially instead of following the
+// linked lists of cobra::Solution. Routes are flattened lazily on first access and stay valid until invalidated: the
+// owner must invalidate a route whenever it modifies it and invalidate everything whenever the solution is modified
+// elsewhere (e.g. by the local search).
+class FlatRoutes {
+
+ public:
+
+    struct Route {
+        // vertices[0] and vertices[size + 1] are the depot
+        std::vector<int> vertices;
+        // arc_costs[k] is the cost of the arc (vertices[k - 1], vertices[k]), arc_costs[0] is unused
+        std::vector<float> arc_costs;
+        unsigned int epoch = 0;
+    };
+
+ private:
+
+    const cobra::Instance& instance;
+    const CostTable& costs;
+
+    std::vector<Route> routes;
+    // position of each vertex in the flat copy of its route, meaningful only while the route is valid
+    std::vector<int> positions;
+    // routes flattened during the current epoch are valid
+    unsigned int epoch = 1;
+
+ public:
+
+    FlatRoutes(const cobra::Instance& instance_, const CostTable& costs_) : instance(instance_), costs(costs_), positions(instance_.get_vertices_num(), 0) { }
+
+    void invalidate() {
+        if (++epoch == 0) {
+            for (auto& route : routes) {
+                route.epoch = 0;
+            }
+            epoch = 1;
+        }
+    }
+
+    void invalidate(int route) {
+        if (route < static_cast<int>(routes.size())) {
+            routes[route].epoch = 0;
+        }
+    }
+
+    bool is_valid(int route) const {
+        return route < static_cast<int>(routes.size()) && routes[route].epoch == epoch;
+    }
+
+    // Returns the flat copy of route, flattening it if needed.
+    const Route& get(const cobra::Solution& solution, int route) {
+
+        if (route >= static_cast<int>(routes.size())) {
+            routes.resize(route + 1);
+        }
+
+        auto& flat = routes[route];
+
+        if (flat.epoch != epoch) {
+
+            const auto depot = instance.get_depot();
+
+            flat.vertices.clear();
+            flat.arc_costs.clear();
+
+            flat.vertices.push_back(depot);
+            flat.arc_costs.push_back(0.0f);
+            for (auto curr = solution.get_first_customer(route); curr != depot; curr = solution.get_next_vertex(curr)) {
+                positions[curr] = static_cast<int>(flat.vertices.size());
+                flat.arc_costs.push_back(costs.get_cost(flat.vertices.back(), curr));
+                flat.vertices.push_back(curr);
+            }
+            flat.arc_costs.push_back(costs.get_cost(flat.vertices.back(), depot));
+            flat.vertices.push_back(depot);
+
+            flat.epoch = epoch;
+
+        }
+
+        return flat;
+
+    }
+
+    // Position of customer in the flat copy of its route, which must be valid.
+    int get_position(int customer) const {
+        return positions[customer];
+    }
+
+};
+
+#endif //FILO__FLATROUTES_HPP_
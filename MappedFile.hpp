@@ -0,0 +1,66 @@
+#ifndef FILO__MAPPEDFILE_HPP_
+#define FILO__MAPPEDFILE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. The mapping is invalid (is_valid() returns false) when the file cannot be
+// opened or mapped, or when it is empty.
+class MappedFile {
+
+    const char* data = nullptr;
+    size_t size = 0;
+
+ public:
+
+    explicit MappedFile(const std::string& path) {
+
+        const auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) { return; }
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+            auto ptr = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                madvise(ptr, file_stat.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(ptr);
+                size = file_stat.st_size;
+            }
+        }
+
+        close(fd);
+
+    }
+
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<char*>(data), size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_valid() const { return data != nullptr; }
+
+    std::string_view get_view() const { return {data, size}; }
+
+    // 64-bit FNV-1a hash of the file content, 0 if the mapping is invalid.
+    uint64_t get_digest() const {
+        if (!data) { return 0; }
+        auto hash = uint64_t{14695981039346656037ull};
+        for (auto n = 0ul; n < size; n++) {
+            hash ^= static_cast<unsigned char>(data[n]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+};
+
+#endif //FILO__MAPPEDFILE_HPP_
@@ -0,0 +1,163 @@
+#ifndef FILO__MEASUREDNEIGHBORHOODDESCENT_HPP_
+#define FILO__MEASUREDNEIGHBORHOODDESCENT_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include <cobra/LocalSearch.hpp>
+#include "Profile.hpp"
+
+inline const char* get_operator_name(cobra::Operator op) {
+    switch (op) {
+        case cobra::E11: return "E11";
+        case cobra::E10: return "E10";
+        case cobra::TAILS: return "TAILS";
+        case cobra::SPLIT: return "SPLIT";
+        case cobra::RE22B: return "RE22B";
+        case cobra::E22: return "E22";
+        case cobra::RE20: return "RE20";
+        case cobra::RE21: return "RE21";
+        case cobra::RE22S: return "RE22S";
+        case cobra::E21: return "E21";
+        case cobra::E20: return "E20";
+        case cobra::TWOPT: return "TWOPT";
+        case cobra::RE30: return "RE30";
+        case cobra::E30: return "E30";
+        case cobra::RE33B: return "RE33B";
+        case cobra::E33: return "E33";
+        case cobra::RE31: return "RE31";
+        case cobra::RE32B: return "RE32B";
+        case cobra::RE33S: return "RE33S";
+        case cobra::E31: return "E31";
+        case cobra::E32: return "E32";
+        case cobra::RE32S: return "RE32S";
+        case cobra::EJCH: return "EJCH";
+        default: return "UNKNOWN";
+    }
+}
+
+// Randomized variable neighborhood descent behaving as cobra::RandomizedVariableNeighborhoodDescent, i.e. applying its
+// operators once each in random order, in which every operator is wrapped in a single operator descent so that its
+// invocations, running time and cost decrease can be measured. The operators themselves live in cobra, hence what
+// happens inside an invocation (evaluated and applied moves) is not visible here.
+//
+// In adaptive mode the measurements also drive the descent, bandit style: each operator keeps an exponentially weighted
+// average of the cost decrease per second of its recent invocations, is invoked with probability proportional to that
+// reward relative to the best operator (but never below min_probability), and the invoked operators are ordered by a
+// random permutation weighted by the same probabilities. Expensive operators which rarely improve are thus mostly
+// skipped, while still being sampled often enough to be promoted again when they start paying off.
+template <bool handle_partial_solutions = false>
+class MeasuredNeighborhoodDescent : public cobra::VariableNeighborhoodDescentInterface {
+
+    // weight of the latest invocation in the average reward
+    static constexpr auto reward_decay = 0.01;
+    static constexpr auto min_probability = 0.05;
+    // invocations of an operator before its reward is trusted
+    static constexpr auto warmup_invocations = 100l;
+
+    std::vector<std::unique_ptr<cobra::RandomizedVariableNeighborhoodDescent<handle_partial_solutions>>> descents;
+    std::vector<Profile::OperatorStatistics> statistics;
+    std::vector<int> order;
+    std::mt19937& rand_engine;
+
+    const bool adaptive;
+    std::vector<double> rewards;
+    std::vector<double> probabilities;
+    std::vector<double> keys;
+    std::uniform_real_distribution<double> uniform_01_dist;
+
+    void sort_adaptively() {
+
+        const auto max_reward = *std::max_element(rewards.begin(), rewards.end());
+
+        for (auto n = 0u; n < descents.size(); n++) {
+            if (statistics[n].invocations < warmup_invocations || max_reward <= 0.0) {
+                probabilities[n] = 1.0;
+            } else {
+                probabilities[n] = std::max(min_probability, rewards[n] / max_reward);
+            }
+            // weighted random permutation, the larger the key the earlier the operator
+            keys[n] = std::log(std::max(uniform_01_dist(rand_engine), std::numeric_limits<double>::min())) / probabilities[n];
+        }
+
+        std::sort(order.begin(), order.end(), [this](int a, int b) { return keys[a] > keys[b]; });
+
+    }
+
+ public:
+
+    MeasuredNeighborhoodDescent(const cobra::Instance& instance, cobra::MoveGenerators& move_generators, const std::vector<cobra::Operator>& operators,
+                                std::mt19937& rand_engine_, float tolerance, bool adaptive_ = false) :
+        order(operators.size()),
+        rand_engine(rand_engine_),
+        adaptive(adaptive_),
+        rewards(operators.size(), 0.0),
+        probabilities(operators.size(), 1.0),
+        keys(operators.size(), 0.0),
+        uniform_01_dist(0.0, 1.0) {
+
+        for (auto op : operators) {
+            descents.emplace_back(std::make_unique<cobra::RandomizedVariableNeighborhoodDescent<handle_partial_solutions>>(
+                instance, move_generators, std::vector<cobra::Operator>{op}, rand_engine, tolerance));
+            statistics.emplace_back();
+            statistics.back().name = get_operator_name(op);
+        }
+
+        std::iota(order.begin(), order.end(), 0);
+
+    }
+
+    void apply(cobra::Solution& solution) override {
+
+        if (adaptive) {
+            sort_adaptively();
+        } else {
+            std::shuffle(order.begin(), order.end(), rand_engine);
+        }
+
+        for (auto n : order) {
+
+            if (adaptive && probabilities[n] < 1.0 && uniform_01_dist(rand_engine) >= probabilities[n]) {
+                continue;
+            }
+
+            const auto cost_before = solution.get_cost();
+            const auto begin = std::chrono::high_resolution_clock::now();
+
+            descents[n]->apply(solution);
+
+            const auto end = std::chrono::high_resolution_clock::now();
+            const auto seconds = std::chrono::duration<double>(end - begin).count();
+            const auto gain = std::max(0.0, static_cast<double>(cost_before - solution.get_cost()));
+
+            auto& operator_statistics = statistics[n];
+            operator_statistics.invocations++;
+            operator_statistics.seconds += seconds;
+            if (gain > 0.0) {
+                operator_statistics.improving_invocations++;
+                operator_statistics.gain += gain;
+            }
+
+            if (seconds > 0.0) {
+                rewards[n] += reward_decay * (gain / seconds - rewards[n]);
+            }
+
+        }
+
+    }
+
+    const std::vector<Profile::OperatorStatistics>& get_statistics() const {
+        return statistics;
+    }
+
+};
+
+#endif //FILO__MEASUREDNEIGHBORHOODDESCENT_HPP_
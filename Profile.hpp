@@ -0,0 +1,183 @@
+#ifndef FILO__PROFILE_HPP_
+#define FILO__PROFILE_HPP_
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "atomic_file.hpp"
+
+// Always-on record of where a run spends its time, stored as a JSON report next to the .out file. It holds the wall time
+// of each phase (pre-processing steps, CLARKE&WRIGHT, ROUTEMIN, COREOPT), the split of the COREOPT iterations of the
+// main trajectory into shaking, local search and bookkeeping, and a few hot path counters. Recording costs a handful of
+// clock reads per COREOPT iteration.
+class Profile {
+
+ public:
+
+    struct CoreoptBreakdown {
+        long iterations = 0;
+        // the phase times below are measured on sampled iterations only, following the amortized clock of COREOPT, and
+        // each sample is weighted by the iterations it stands for
+        long sampled_iterations = 0;
+        // best solution exchanges with other trajectories and decomposition steps
+        double migration_and_decomposition_seconds = 0.0;
+        // ruin and recreate
+        double shaking_seconds = 0.0;
+        double local_search_seconds = 0.0;
+        // acceptance, gamma and omega updates
+        double bookkeeping_seconds = 0.0;
+        // insertion positions evaluated by the recreate step
+        unsigned long insertion_positions_evaluated = 0;
+        // size of the solution cache after local search, i.e. the n. of vertices touched by an iteration
+        double cache_size_sum = 0.0;
+        int cache_size_max = 0;
+        // decomposition steps, their wall time and the ruin and recreate plus local search iterations run by all the
+        // decomposition threads
+        long decomposition_steps = 0;
+        double decomposition_seconds = 0.0;
+        long decomposition_cluster_iterations = 0;
+    };
+
+    struct CostTableDescription {
+        // "full_matrix" or "sparse", empty when unknown
+        std::string backend;
+        // neighbors whose costs are stored per vertex by the sparse backend
+        int neighbors = 0;
+        // whether the sparse backend computes the other costs from coordinates
+        bool euclidean = false;
+        size_t memory_bytes = 0;
+    };
+
+    struct OperatorStatistics {
+        std::string name;
+        long invocations = 0;
+        // invocations which decreased the solution cost
+        long improving_invocations = 0;
+        // total cost decrease
+        double gain = 0.0;
+        double seconds = 0.0;
+    };
+
+ private:
+
+    std::vector<std::pair<std::string, double>> phases;
+    CoreoptBreakdown coreopt;
+    CostTableDescription cost_table;
+    std::vector<OperatorStatistics> operators;
+
+    static void write_string(std::ostream& stream, const std::string& value) {
+        stream << '"';
+        for (auto c : value) {
+            if (c == '"' || c == '\\') {
+                stream << '\\' << c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                stream << ' ';
+            } else {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+
+ public:
+
+    void add_phase(const std::string& name, double seconds) {
+        phases.emplace_back(name, seconds);
+    }
+
+    // Appends the phases of other, e.g. the shared pre-processing, to this profile, and takes its cost table description.
+    void add_preprocessing(const Profile& other) {
+        phases.insert(phases.end(), other.phases.begin(), other.phases.end());
+        cost_table = other.cost_table;
+    }
+
+    void set_cost_table(const std::string& backend, int neighbors, bool euclidean, size_t memory_bytes) {
+        cost_table = {backend, neighbors, euclidean, memory_bytes};
+    }
+    const CostTableDescription& get_cost_table() const { return cost_table; }
+
+    CoreoptBreakdown& get_coreopt() { return coreopt; }
+    const CoreoptBreakdown& get_coreopt() const { return coreopt; }
+    const std::vector<std::pair<std::string, double>>& get_phases() const { return phases; }
+
+    // Per operator local search statistics, only collected on request.
+    void add_operators(const std::vector<OperatorStatistics>& statistics) {
+        operators.insert(operators.end(), statistics.begin(), statistics.end());
+    }
+    const std::vector<OperatorStatistics>& get_operators() const { return operators; }
+
+    void write_json(std::ostream& stream, const std::string& instance, int seed, double cost, int routes) const {
+
+        stream.precision(std::numeric_limits<double>::max_digits10);
+
+        stream << "{\n";
+        stream << "  \"instance\": ";
+        write_string(stream, instance);
+        stream << ",\n";
+        stream << "  \"seed\": " << seed << ",\n";
+        stream << "  \"cost\": " << cost << ",\n";
+        stream << "  \"routes\": " << routes << ",\n";
+
+        stream << "  \"phases\": [";
+        for (auto n = 0u; n < phases.size(); n++) {
+            stream << (n ? ",\n" : "\n") << "    {\"name\": ";
+            write_string(stream, phases[n].first);
+            stream << ", \"seconds\": " << phases[n].second << "}";
+        }
+        stream << (phases.empty() ? "],\n" : "\n  ],\n");
+
+        stream << "  \"cost_table\": {\"backend\": ";
+        write_string(stream, cost_table.backend);
+        stream << ", \"neighbors\": " << cost_table.neighbors << ", \"euclidean\": " << (cost_table.euclidean ? "true" : "false")
+               << ", \"memory_bytes\": " << cost_table.memory_bytes << "},\n";
+
+        const auto iterations = std::max(1l, coreopt.iterations);
+        const auto coreopt_seconds = coreopt.migration_and_decomposition_seconds + coreopt.shaking_seconds + coreopt.local_search_seconds +
+                                     coreopt.bookkeeping_seconds;
+
+        stream << "  \"coreopt\": {\n";
+        stream << "    \"iterations\": " << coreopt.iterations << ",\n";
+        stream << "    \"sampled_iterations\": " << coreopt.sampled_iterations << ",\n";
+        stream << "    \"iterations_per_second\": " << (coreopt_seconds > 0.0 ? static_cast<double>(coreopt.iterations) / coreopt_seconds : 0.0) << ",\n";
+        stream << "    \"migration_and_decomposition_seconds\": " << coreopt.migration_and_decomposition_seconds << ",\n";
+        stream << "    \"shaking_seconds\": " << coreopt.shaking_seconds << ",\n";
+        stream << "    \"local_search_seconds\": " << coreopt.local_search_seconds << ",\n";
+        stream << "    \"bookkeeping_seconds\": " << coreopt.bookkeeping_seconds << ",\n";
+        stream << "    \"insertion_positions_evaluated\": " << coreopt.insertion_positions_evaluated << ",\n";
+        stream << "    \"mean_cache_size\": " << coreopt.cache_size_sum / static_cast<double>(iterations) << ",\n";
+        stream << "    \"max_cache_size\": " << coreopt.cache_size_max << ",\n";
+        stream << "    \"decomposition_steps\": " << coreopt.decomposition_steps << ",\n";
+        stream << "    \"decomposition_seconds\": " << coreopt.decomposition_seconds << ",\n";
+        stream << "    \"decomposition_cluster_iterations_per_second\": "
+               << (coreopt.decomposition_seconds > 0.0 ? static_cast<double>(coreopt.decomposition_cluster_iterations) / coreopt.decomposition_seconds : 0.0) << "\n";
+        stream << "  },\n";
+
+        stream << "  \"operators\": [";
+        for (auto n = 0u; n < operators.size(); n++) {
+            const auto& op = operators[n];
+            stream << (n ? ",\n" : "\n") << "    {\"name\": ";
+            write_string(stream, op.name);
+            stream << ", \"invocations\": " << op.invocations << ", \"improving_invocations\": " << op.improving_invocations << ", \"gain\": " << op.gain
+                   << ", \"seconds\": " << op.seconds << "}";
+        }
+        stream << (operators.empty() ? "]\n" : "\n  ]\n");
+        stream << "}\n";
+
+    }
+
+    // Writes to a temporary file which is then renamed, as for the other outputs.
+    bool store(const std::string& path, const std::string& instance, int seed, double cost, int routes) const {
+
+        return atomic_file::write(path, std::ios::out, [&](std::ofstream& stream) {
+            write_json(stream, instance, seed, cost, routes);
+        });
+
+    }
+
+};
+
+#endif //FILO__PROFILE_HPP_
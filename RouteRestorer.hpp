@@ -0,0 +1,113 @@
+#ifndef FILO__ROUTERESTORER_HPP_
+#define FILO__ROUTERESTORER_HPP_
+
+#include <algorithm>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/LRUCache.hpp>
+
+// Copies the routes in which two solutions differ from one to the other, when the vertices whose neighborhood may have
+// changed are known, e.g. those in the cache of a solution obtained from the other by ruin and recreate and local search.
+// Any route in which the two solutions differ holds one of those vertices in both, hence only the routes holding them are
+// removed and rebuilt, as in Decomposition::merge, for a cost proportional to the touched region instead of the
+// solution size. The cache must not have evicted any entry, see is_complete().
+// The cost of target is updated by the removal and insertion deltas. Those are exact with rounded costs, whereas with
+// real-valued costs their rounding errors would accumulate over the iterations and target would drift away from the
+// cost of source: the cost of target is then recomputed, a read-only pass over its routes which is still cheaper than a
+// copy of the whole solution.
+class RouteRestorer {
+
+    const cobra::Instance& instance;
+    const int cache_capacity;
+    const bool round_costs;
+
+    std::vector<int> target_routes;
+    std::vector<int> source_routes;
+
+ public:
+
+    // cache_capacity is the capacity of the solution caches, as given to the cobra::Solution constructor, and round_costs
+    // whether the instance has been built with rounded costs.
+    RouteRestorer(const cobra::Instance& instance_, int cache_capacity_, bool round_costs_) : instance(instance_), cache_capacity(cache_capacity_),
+                                                                                              round_costs(round_costs_) { }
+
+    // Whether cache may be used by restore(), i.e. it has not been filled up and thus has not evicted any vertex.
+    bool is_complete(const cobra::LRUCache& cache) const {
+        return static_cast<int>(cache.size()) < cache_capacity;
+    }
+
+    // Makes target equal to source, given the vertices in which they may differ. Clears the cache of target.
+    void restore(cobra::Solution& target, const cobra::Solution& source, const cobra::LRUCache& changed) {
+
+        target_routes.clear();
+        source_routes.clear();
+
+        for (auto i = changed.begin(); i != cobra::LRUCache::Entry::dummy_vertex; i = changed.get_next(i)) {
+            add_routes(target, source, i);
+        }
+
+        rebuild(target, source);
+
+    }
+
+    // As above, with the vertices given as a list which may hold duplicates, e.g. the union of several caches when
+    // target and source have both been changed since they were equal.
+    void restore(cobra::Solution& target, const cobra::Solution& source, const std::vector<int>& changed) {
+
+        target_routes.clear();
+        source_routes.clear();
+
+        for (auto i : changed) {
+            add_routes(target, source, i);
+        }
+
+        rebuild(target, source);
+
+    }
+
+ private:
+
+    void add_routes(const cobra::Solution& target, const cobra::Solution& source, int i) {
+        if (i == instance.get_depot()) { return; }
+        if (target.is_customer_in_solution(i)) { target_routes.push_back(target.get_route_index(i)); }
+        if (source.is_customer_in_solution(i)) { source_routes.push_back(source.get_route_index(i)); }
+    }
+
+    void rebuild(cobra::Solution& target, const cobra::Solution& source) {
+
+        const auto depot = instance.get_depot();
+
+        std::sort(target_routes.begin(), target_routes.end());
+        target_routes.erase(std::unique(target_routes.begin(), target_routes.end()), target_routes.end());
+        std::sort(source_routes.begin(), source_routes.end());
+        source_routes.erase(std::unique(source_routes.begin(), source_routes.end()), source_routes.end());
+
+        for (auto route : target_routes) {
+            auto curr = target.get_first_customer(route);
+            do {
+                const auto next = target.get_next_vertex(curr);
+                target.remove_vertex(route, curr);
+                curr = next;
+            } while (curr != depot);
+            target.remove_route(route);
+        }
+
+        for (auto route : source_routes) {
+            const auto first = source.get_first_customer(route);
+            target.build_one_customer_route(first);
+            const auto new_route = target.get_route_index(first);
+            for (auto curr = source.get_next_vertex(first); curr != depot; curr = source.get_next_vertex(curr)) {
+                target.insert_vertex_before(new_route, depot, curr);
+            }
+        }
+
+        if (!round_costs) { target.recompute_costs(); }
+
+        target.clear_cache();
+
+    }
+
+};
+
+#endif //FILO__ROUTERESTORER_HPP_
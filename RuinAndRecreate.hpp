@@ -8,30 +8,72 @@
 #include <cobra/Instance.hpp>
 #include <random>
 #include <cobra/Solution.hpp>
+#include "BestInsertion.hpp"
+#include "CostTable.hpp"
 
 class RuinAndRecreate {
 
     const cobra::Instance& instance;
+    const CostTable& costs;
     std::mt19937& rand_engine;
     std::uniform_int_distribution<int> boolean_dist;
     std::uniform_int_distribution<int> customers_distribution;
     std::uniform_int_distribution<int> rand_uniform;
 
+    // number of neighbors whose adjacent positions are evaluated when reinserting a customer, 0 means exhaustive scan
+    const int recreate_neighbors;
+
+    BestInsertion insertion;
+
+    // scratch storage reused across calls: removed customers and routes visited by the ruin step, the latter marked by
+    // stamping them with the id of the current call
+    std::vector<int> removed;
+    std::vector<unsigned int> route_stamps;
+    unsigned int stamp = 0;
+
+    void mark_route(int route) {
+        if (route >= static_cast<int>(route_stamps.size())) {
+            route_stamps.resize(route + 1, 0);
+        }
+        route_stamps[route] = stamp;
+    }
+
+    bool is_route_marked(int route) const {
+        return route < static_cast<int>(route_stamps.size()) && route_stamps[route] == stamp;
+    }
+
  public:
 
-    RuinAndRecreate(const cobra::Instance& instance_, std::mt19937& rand_engine_) : instance(instance_),
+    RuinAndRecreate(const cobra::Instance& instance_, const CostTable& costs_, std::mt19937& rand_engine_, int recreate_neighbors_ = 0, bool flat_routes = false) : instance(instance_),
+                                                                                    costs(costs_),
                                                                                     rand_engine(rand_engine_),
                                                                                     boolean_dist(std::uniform_int_distribution(0, 1)),
                                                                                     customers_distribution(instance.get_customers_begin(), instance.get_customers_end() - 1),
-                                                                                    rand_uniform(0, 3){
+                                                                                    rand_uniform(0, 3),
+                                                                                    recreate_neighbors(recreate_neighbors_),
+                                                                                    insertion(instance_, costs_, flat_routes),
+                                                                                    route_stamps(instance_.get_vertices_num(), 0) {
+        removed.reserve(instance.get_customers_num());
+    }
+
+    // Insertion positions evaluated by the recreate steps so far.
+    unsigned long get_insertion_positions_evaluated() const {
+        return insertion.get_evaluated_positions();
+    }
 
+    int apply(cobra::Solution& solution, const std::vector<int>& omega) {
+        return apply(solution, omega, customers_distribution(rand_engine));
     }
-    int apply(cobra::Solution& solution, std::vector<int>& omega) {
 
-        auto removed = std::vector<int>();
-        auto routes = std::unordered_set<int>();
+    // Ruins the solution starting from the given seed customer, which must be served by the solution.
+    int apply(cobra::Solution& solution, const std::vector<int>& omega, int seed) {
+
+        removed.clear();
+        if (++stamp == 0) {
+            std::fill(route_stamps.begin(), route_stamps.end(), 0);
+            stamp = 1;
+        }
 
-        auto seed = customers_distribution(rand_engine);
         const auto N =  omega[seed];
 
         auto curr = seed;
@@ -45,7 +87,7 @@ class RuinAndRecreate {
             auto route = solution.get_route_index(curr);
 
             removed.push_back(curr);
-            routes.insert(route);
+            mark_route(route);
 
             if(solution.get_route_size(route) > 1 && boolean_dist(rand_engine)) {
                 // move within the current route
@@ -69,7 +111,7 @@ class RuinAndRecreate {
 
                     for(auto m = 1u; m < instance.get_neighbors_of(curr).size(); m++) {
                         const auto neighbor = instance.get_neighbors_of(curr)[m];
-                        if(neighbor == instance.get_depot() || !solution.is_customer_in_solution(neighbor) || routes.count(solution.get_route_index(neighbor))) { continue; }
+                        if(neighbor == instance.get_depot() || !solution.is_customer_in_solution(neighbor) || is_route_marked(solution.get_route_index(neighbor))) { continue; }
                         next = neighbor;
                         break;
                     }
@@ -115,63 +157,34 @@ class RuinAndRecreate {
                 break;
             case 2:
                 std::sort(removed.begin(), removed.end(), [this](int a, int b) {
-                    return instance.get_cost(a, instance.get_depot()) > instance.get_cost(b, instance.get_depot());
+                    return costs.get_cost(a, instance.get_depot()) > costs.get_cost(b, instance.get_depot());
                 });
                 break;
             case 3:
                 std::sort(removed.begin(), removed.end(), [this](int a, int b) {
-                    return instance.get_cost(a, instance.get_depot()) < instance.get_cost(b, instance.get_depot());
+                    return costs.get_cost(a, instance.get_depot()) < costs.get_cost(b, instance.get_depot());
                 });
                 break;
 
         }
 
 
+        insertion.invalidate();
+
         for (auto customer : removed) {
 
             assert(customer != instance.get_depot());
 
-            auto best_route = cobra::Solution::dummy_route;
-            auto best_where = cobra::Solution::dummy_vertex;
-            auto best_cost = std::numeric_limits<float>::max();
-
-            for(auto route = solution.get_first_route(); route != cobra::Solution::dummy_route; route = solution.get_next_route(route)){
-
-                if (solution.get_route_load(route) + instance.get_demand(customer) > instance.get_vehicle_capacity()) { continue; }
-
-                for (auto where = solution.get_first_customer(route); where != instance.get_depot(); where = solution.get_next_vertex(where)) {
-
-                    const auto prev = solution.get_prev_vertex(where);
-
-                    const auto cost = -instance.get_cost(prev, where) + instance.get_cost(prev, customer) + instance.get_cost(customer, where);
-
-                    if (cost < best_cost) {
-
-                        best_cost = cost;
-                        best_route = route;
-                        best_where = where;
-
-                    }
-                }
-
-                const auto cost = -instance.get_cost(instance.get_depot(), solution.get_last_customer(route))
-                    + instance.get_cost(solution.get_last_customer(route), customer)
-                    + instance.get_cost(customer, instance.get_depot());
-
-                if (cost < best_cost) {
-
-                    best_cost = cost;
-                    best_route = route;
-                    best_where = instance.get_depot();
-
-                }
-
-            }
+            // a customer that none of the routes of its neighbors can host is served by a new route from the depot
+            const auto best = recreate_neighbors > 0 ? insertion.find_best_among_neighbors(solution, customer, recreate_neighbors)
+                                                     : insertion.find_best(solution, customer);
 
-            if (best_route == cobra::Solution::dummy_route) {
+            if (best.route == cobra::Solution::dummy_route) {
                 solution.build_one_customer_route(customer);
+                insertion.invalidate(solution.get_route_index(customer));
             } else {
-                solution.insert_vertex_before(best_route, best_where, customer);
+                solution.insert_vertex_before(best.route, best.where, customer);
+                insertion.invalidate(best.route);
             }
 
         }
@@ -0,0 +1,482 @@
+#include "Solver.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include <tuple>
+#include "bpp.hpp"
+#include "mean_arc_cost.hpp"
+#include "routemin.hpp"
+#include "coreopt.hpp"
+#include "instance_cache.hpp"
+#include "neighbor_cache.hpp"
+#include "BestInsertion.hpp"
+#include "solution_io.hpp"
+
+Solver::Solver(const cobra::Instance& instance_, const Parameters& parameters_, bool round_costs_, std::optional<double> known_mean_arc_cost) :
+    instance(instance_), parameters(parameters_), round_costs(round_costs_) {
+
+    #ifdef VERBOSE
+    auto partial_time_begin = std::chrono::high_resolution_clock::now();
+    auto partial_time_end = std::chrono::high_resolution_clock::now();
+    #endif
+
+    // the wall time of each pre-processing step is recorded in the profile
+    auto phase_begin = std::chrono::high_resolution_clock::now();
+    const auto end_phase = [this, &phase_begin](const std::string& name) {
+        preprocessing_profile.add_phase(name, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - phase_begin).count());
+    };
+
+    // pre-processing results stored by a previous run on the same instance file
+    phase_begin = std::chrono::high_resolution_clock::now();
+    // a known mean arc cost means that instance is not the content of the instance file, hence caches are not used
+    const auto instance_cache_path = known_mean_arc_cost ? std::string() : parameters.get_instance_cache();
+    const auto neighbor_cache_path = known_mean_arc_cost ? std::string() : parameters.get_neighbor_cache();
+    auto instance_digest = uint64_t{0};
+    if (!instance_cache_path.empty() || !neighbor_cache_path.empty()) {
+        const auto instance_file = MappedFile(parameters.get_instance_path());
+        instance_digest = instance_cache::get_digest(instance_file, parameters.get_parser());
+    }
+    auto cached_preprocessing = std::optional<instance_cache::Record>();
+    if (!instance_cache_path.empty()) {
+        cached_preprocessing = instance_cache::load(instance_cache_path, instance_digest, instance.get_vertices_num());
+        #ifdef VERBOSE
+        std::cout << "Instance cache " << (cached_preprocessing ? "hit" : "miss") << " in '" << instance_cache::get_path(instance_cache_path, instance_digest) << "'.\n\n";
+        #endif
+    }
+
+    #ifdef VERBOSE
+    std::cout << "Computing mean arc cost.\n";
+    partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    const auto mean_arc_cost_samples = parameters.get_mean_arc_cost_samples();
+    const auto arcs_num = static_cast<double>(instance.get_vertices_num()) * (instance.get_vertices_num() - 1) / 2.0;
+
+    const auto sample_mean_arc_cost = mean_arc_cost_samples > 0 && mean_arc_cost_samples < arcs_num;
+
+    auto mean_arc_cost_standard_error = 0.0;
+    if (known_mean_arc_cost) {
+        mean_arc_cost = *known_mean_arc_cost;
+    } else if (cached_preprocessing) {
+        mean_arc_cost = cached_preprocessing->mean_arc_cost;
+    } else if (sample_mean_arc_cost) {
+        std::tie(mean_arc_cost, mean_arc_cost_standard_error) = mean_arc_cost::estimate(instance, mean_arc_cost_samples, parameters.get_seed());
+    } else {
+        mean_arc_cost = mean_arc_cost::compute(instance, parameters.get_preprocessing_threads());
+    }
+
+    end_phase("mean_arc_cost");
+
+    #ifdef VERBOSE
+    partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n";
+    if (mean_arc_cost_standard_error > 0.0) {
+        std::cout << "Mean arc cost value is " << mean_arc_cost << " +/- " << 2.0 * mean_arc_cost_standard_error << " (95% confidence, " << mean_arc_cost_samples << " sampled arcs).\n";
+    } else {
+        std::cout << "Mean arc cost value is " << mean_arc_cost << ".\n";
+    }
+
+    std::cout << "Computing a greedy upper bound on the n. of routes.\n";
+    partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    phase_begin = std::chrono::high_resolution_clock::now();
+
+    kmin = cached_preprocessing ? cached_preprocessing->kmin : bpp::greedy_first_fit_decreasing(instance);
+
+    end_phase("greedy_routes_bound");
+
+    // only exact values are cached, so that a cache hit never depends on the sampling seed
+    if (!instance_cache_path.empty() && !cached_preprocessing && !sample_mean_arc_cost) {
+        if (!instance_cache::store(instance_cache_path, instance_digest, instance.get_vertices_num(), mean_arc_cost, kmin)) {
+            std::cout << "Warning: unable to store the instance cache in '" << instance_cache_path << "'.\n";
+        }
+    }
+
+    #ifdef VERBOSE
+    partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n";
+    std::cout << "Around " << kmin << " routes should do the job, at least " << bpp::lower_bound(instance) << " are needed.\n\n";
+
+    std::cout << "Setting up the cost table.\n";
+    partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    // neighbors whose costs are stored by the sparse backend, i.e. those evaluated by the neighbor-restricted recreate
+    const auto cost_table_neighbors = std::max(parameters.get_sparsification_rule_neighbors(), parameters.get_recreate_neighbors()) + 1;
+    phase_begin = std::chrono::high_resolution_clock::now();
+    const auto cost_table_digest = neighbor_cache::get_digest(instance_digest, round_costs, parameters.get_cost_matrix_max_vertices(), cost_table_neighbors);
+    if (!neighbor_cache_path.empty()) {
+        costs = neighbor_cache::load(neighbor_cache_path, cost_table_digest, instance, round_costs);
+        #ifdef VERBOSE
+        std::cout << "Neighbor cache " << (costs ? "hit" : "miss") << " in '" << neighbor_cache::get_path(neighbor_cache_path, cost_table_digest) << "'.\n";
+        #endif
+    }
+    if (!costs) {
+        costs = std::make_unique<CostTable>(instance, round_costs, parameters.get_cost_matrix_max_vertices(), cost_table_neighbors,
+                                            parameters.get_preprocessing_threads());
+        if (!neighbor_cache_path.empty() && !neighbor_cache::store(neighbor_cache_path, cost_table_digest, instance, *costs)) {
+            std::cout << "Warning: unable to store the neighbor cache in '" << neighbor_cache_path << "'.\n";
+        }
+    }
+    end_phase("cost_table");
+
+    // the cost table is the largest pre-processed structure, hence its backend and memory are always recorded in the profile
+    preprocessing_profile.set_cost_table(costs->get_backend() == CostTable::Backend::FULL_MATRIX ? "full_matrix" : "sparse",
+                                         costs->get_neighbors_num(), costs->is_euclidean(), costs->get_memory_usage());
+
+    #ifdef VERBOSE
+    partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n";
+    if (costs->get_backend() == CostTable::Backend::FULL_MATRIX) {
+        std::cout << "Using the full cost matrix";
+    } else {
+        std::cout << "Using a sparse cost table with " << costs->get_neighbors_num() << " neighbors per vertex, other costs are "
+                  << (costs->is_euclidean() ? "computed from coordinates" : "requested to the instance");
+    }
+    std::cout << " (" << costs->get_memory_usage() / (1024.0 * 1024.0) << " MB).\n";
+    std::cout << "\n";
+    std::cout << "Setting up MOVEGENERATORS data structures.\n";
+    partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    phase_begin = std::chrono::high_resolution_clock::now();
+
+    auto k = parameters.get_sparsification_rule_neighbors();
+    knn_view = std::make_unique<cobra::KNeighborsMoveGeneratorsView>(instance, k);
+
+    views.push_back(knn_view.get());
+
+    move_generators = std::make_unique<cobra::MoveGenerators>(instance, views);
+
+    end_phase("move_generators");
+
+    #ifdef VERBOSE
+    partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n";
+    const auto tot_arcs = instance.get_vertices_num() * instance.get_vertices_num();
+    const auto move_gen_num = move_generators->get_raw_vector().size();
+    const auto move_gen_perc = 100.0f * move_gen_num / tot_arcs;
+    std::cout << "Using at most " << move_generators->get_raw_vector().size() << " move-generators out of " << tot_arcs << " total arcs ";
+    std::cout << std::fixed;
+    std::cout << std::setprecision(2);
+    std::cout << "(approx. " << move_gen_perc << "%):\n";
+    std::cout << std::setprecision(10);
+    std::cout << std::defaultfloat;
+    std::cout << std::setw(10);
+    std::cout << knn_view->get_number_of_moves() << " k=" << k << " nearest-neighbors arcs\n";
+    std::cout << "\n";
+    #endif
+
+}
+
+std::string Solver::get_output_path(int seed, const std::string& extension) const {
+    return parameters.get_outpath() + get_basename(parameters.get_instance_path()) + "_seed-" + std::to_string(seed) + extension;
+}
+
+cobra::Solution Solver::construct() const {
+
+    #ifdef VERBOSE
+    std::cout << "Running CLARKE&WRIGHT to generate an initial solution.\n";
+    const auto partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    auto solution = cobra::Solution(instance, std::min(instance.get_vertices_num(), parameters.get_solution_cache_size()));
+
+    cobra::Solution::clarke_and_wright(instance, solution, parameters.get_cw_lambda(), parameters.get_cw_neighbors());
+
+    #ifdef VERBOSE
+    const auto partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n";
+    std::cout << "Initial solution: obj = " << solution.get_cost() << ", n. of routes = " << solution.get_routes_num() << ".\n\n";
+    #endif
+
+    return solution;
+
+}
+
+cobra::Solution Solver::minimize_routes(const cobra::Solution& solution, std::mt19937& rand_engine, cobra::MoveGenerators& seed_move_generators) {
+
+    if (kmin >= solution.get_routes_num()) {
+        return solution;
+    }
+
+    const auto routemin_iterations = parameters.get_routemin_iterations();
+
+    #ifdef VERBOSE
+    std::cout << "Running ROUTEMIN heuristic for at most " << routemin_iterations << " iterations.\n";
+    std::cout << "Starting solution: obj = " << solution.get_cost() << ", n. of routes = " << solution.get_routes_num() << ".\n";
+    const auto partial_time_begin = std::chrono::high_resolution_clock::now();
+    #endif
+
+    const auto routemin_time_limit = static_cast<double>(parameters.get_routemin_time_fraction()) * parameters.get_time_limit();
+
+    auto minimized = routemin(instance, *costs, solution, rand_engine, seed_move_generators, views, kmin, routemin_iterations, parameters.get_tolerance(),
+                              parameters.get_solution_cache_size(), round_costs, parameters.get_routemin_stagnation(), routemin_time_limit, parameters.get_routemin_threads(), parameters.get_flat_routes(),
+                              parameters.get_adaptive_operators());
+
+    #ifdef VERBOSE
+    std::cout << "Final solution: obj = " << minimized.get_cost() << ", n. routes = " << minimized.get_routes_num() << "\n";
+    const auto partial_time_end = std::chrono::high_resolution_clock::now();
+    std::cout <<"Done in " << std::chrono::duration_cast<std::chrono::seconds>(partial_time_end - partial_time_begin).count() << " seconds.\n\n";
+    #endif
+
+    return minimized;
+
+}
+
+cobra::Solution Solver::optimize(const cobra::Solution& solution, int seed, std::mt19937& rand_engine, cobra::MoveGenerators& seed_move_generators,
+                                 std::chrono::high_resolution_clock::time_point time_begin, const checkpoint::State* resume, Profile* profile) {
+
+    const auto threads_num = std::max(1, parameters.get_threads());
+
+    // decomposition is only used by the main trajectory on large enough instances
+    auto decomposition = std::unique_ptr<Decomposition>();
+    if (parameters.get_decomposition_threads() > 0 && instance.get_customers_num() >= parameters.get_decomposition_min_customers()) {
+
+        #ifdef VERBOSE
+        std::cout << "Setting up DECOMPOSITION data structures for " << parameters.get_decomposition_threads() << " threads.\n";
+        const auto partial_time_begin = std::chrono::high_resolution_clock::now();
+        #endif
+
+        decomposition = std::make_unique<Decomposition>(instance, *costs, views, parameters.get_decomposition_threads(), parameters.get_decomposition_iterations(),
+                                                        seed, parameters.get_recreate_neighbors(), parameters.get_flat_routes(), parameters.get_tolerance(),
+                                                        parameters.get_solution_cache_size(), round_costs);
+
+        #ifdef VERBOSE
+        const auto partial_time_end = std::chrono::high_resolution_clock::now();
+        std::cout << "Done in " << std::chrono::duration_cast<std::chrono::milliseconds>(partial_time_end - partial_time_begin).count() << " milliseconds.\n\n";
+        #endif
+
+    }
+
+    // only the main trajectory is checkpointed and reports its best solutions
+    auto checkpointing = checkpoint::Settings();
+    checkpointing.checkpoint_path = get_output_path(seed, ".checkpoint");
+    checkpointing.solution_path = get_output_path(seed, ".vrp.sol");
+    checkpointing.period = parameters.get_checkpoint_period();
+    checkpointing.resume = resume;
+
+    const auto on_best_solution = callbacks.on_best_solution ? &callbacks.on_best_solution : nullptr;
+
+    if (threads_num == 1) {
+        return coreopt(instance, *costs, parameters, solution, rand_engine, seed_move_generators, mean_arc_cost, round_costs, time_begin, nullptr,
+                       decomposition.get(), &checkpointing, nullptr, on_best_solution, profile, true);
+    }
+
+    #ifdef VERBOSE
+    std::cout << "Running " << threads_num << " concurrent COREOPT trajectories.\n";
+    #endif
+
+    // trajectories share the instance and the move generators views, but each one owns its own solution, random
+    // engine and move generators
+    auto worker_move_generators = std::vector<std::unique_ptr<cobra::MoveGenerators>>();
+    for (auto t = 1; t < threads_num; t++) {
+        worker_move_generators.emplace_back(std::make_unique<cobra::MoveGenerators>(instance, views));
+    }
+
+    auto shared_best = SharedBestSolution(solution);
+
+    auto workers = std::vector<std::thread>();
+    for (auto t = 1; t < threads_num; t++) {
+        workers.emplace_back([&, t]() {
+            auto seed_sequence = std::seed_seq{seed, t};
+            auto worker_rand_engine = std::mt19937(seed_sequence);
+            coreopt(instance, *costs, parameters, solution, worker_rand_engine, *worker_move_generators[t - 1], mean_arc_cost, round_costs, time_begin,
+                    &shared_best, nullptr, nullptr, nullptr, nullptr, nullptr, false);
+        });
+    }
+
+    coreopt(instance, *costs, parameters, solution, rand_engine, seed_move_generators, mean_arc_cost, round_costs, time_begin, &shared_best,
+            decomposition.get(), &checkpointing, nullptr, on_best_solution, profile, true);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto best_solution = shared_best.get();
+
+    #ifdef VERBOSE
+    std::cout << "Best solution among " << threads_num << " trajectories: obj = " << best_solution.get_cost() << ", n. routes = " << best_solution.get_routes_num() << ".\n";
+    #endif
+
+    return best_solution;
+
+}
+
+cobra::Solution Solver::solve(int seed, std::chrono::high_resolution_clock::time_point time_begin, const cobra::Solution* initial_solution,
+                              const checkpoint::State* resume, Profile* profile) {
+    return solve(seed, *move_generators, time_begin, initial_solution, resume, profile);
+}
+
+cobra::Solution Solver::solve(int seed, cobra::MoveGenerators& seed_move_generators, std::chrono::high_resolution_clock::time_point time_begin,
+                              const cobra::Solution* initial_solution, const checkpoint::State* resume, Profile* profile) {
+
+    auto rand_engine = std::mt19937(seed);
+
+    auto phase_begin = std::chrono::high_resolution_clock::now();
+    const auto end_phase = [this, profile, &phase_begin](Phase phase, const std::string& name, const cobra::Solution& solution) {
+        const auto phase_end = std::chrono::high_resolution_clock::now();
+        if (profile) { profile->add_phase(name, std::chrono::duration<double>(phase_end - phase_begin).count()); }
+        if (callbacks.on_phase_end) { callbacks.on_phase_end(phase, solution); }
+        phase_begin = phase_end;
+    };
+
+    auto solution = cobra::Solution(instance, std::min(instance.get_vertices_num(), parameters.get_solution_cache_size()));
+
+    if (resume) {
+        solution = *resume->solution;
+    } else if (initial_solution) {
+        solution = *initial_solution;
+        if(!round_costs) { solution.recompute_costs(); }
+        #ifdef VERBOSE
+        std::cout << "Starting from the given solution: obj = " << solution.get_cost() << ", n. of routes = " << solution.get_routes_num() << ".\n\n";
+        #endif
+    } else {
+        solution = construct();
+        end_phase(Phase::CONSTRUCTION, "clarke_and_wright", solution);
+        solution = minimize_routes(solution, rand_engine, seed_move_generators);
+        end_phase(Phase::ROUTE_MINIMIZATION, "routemin", solution);
+    }
+
+    phase_begin = std::chrono::high_resolution_clock::now();
+    auto best_solution = optimize(solution, seed, rand_engine, seed_move_generators, time_begin, resume, profile);
+    end_phase(Phase::CORE_OPTIMIZATION, "coreopt", best_solution);
+
+    #ifdef VERBOSE
+    const auto time_end = std::chrono::high_resolution_clock::now();
+    std::cout << "\n";
+    std::cout << "Run completed in " << std::chrono::duration_cast<std::chrono::seconds>(time_end - time_begin).count() << " seconds ";
+    std::cout << "(" << std::chrono::duration_cast<std::chrono::milliseconds>(time_end - time_begin).count() << " milliseconds).\n";
+    #endif
+
+    return best_solution;
+
+}
+
+void Solver::store_results(int seed, const cobra::Solution& solution, std::chrono::high_resolution_clock::time_point time_begin,
+                           const Profile* profile) const {
+
+    const auto outfile = get_output_path(seed, ".out");
+    const auto solfile = get_output_path(seed, ".vrp.sol");
+    const auto profilefile = get_output_path(seed, ".profile.json");
+
+    const auto time_end = std::chrono::high_resolution_clock::now();
+
+    auto out_stream = std::ofstream(outfile);
+    out_stream << std::setprecision(10);
+    out_stream << solution.get_cost() << "\t" << std::chrono::duration_cast<std::chrono::seconds>(time_end - time_begin).count() << "\n";
+    solution_io::store(instance, solution, solfile);
+    if (profile) {
+        profile->store(profilefile, get_basename(parameters.get_instance_path()), seed, solution.get_cost(), solution.get_routes_num());
+    }
+
+    #ifdef VERBOSE
+    std::cout << "\n";
+    std::cout << "Results stored in\n";
+    std::cout << " - " << outfile << "\n";
+    std::cout << " - " << solfile << "\n";
+    if (profile) { std::cout << " - " << profilefile << "\n"; }
+    #endif
+
+}
+
+std::optional<cobra::Solution> Solver::reoptimize(const Delta& delta, int seed, int iterations, std::string& error) {
+    auto seed_move_generators = cobra::MoveGenerators(instance, views);
+    return reoptimize(delta, seed, iterations, seed_move_generators, error);
+}
+
+std::optional<cobra::Solution> Solver::reoptimize(const Delta& delta, int seed, int iterations, cobra::MoveGenerators& seed_move_generators,
+                                                  std::string& error) {
+
+    const auto depot = instance.get_depot();
+    const auto is_customer = [this](int vertex) {
+        return vertex >= instance.get_customers_begin() && vertex < instance.get_customers_end();
+    };
+
+    auto affected = std::vector<int>();
+    for (auto vertex : delta.affected) {
+        if (!is_customer(vertex)) {
+            error = "unknown affected customer " + std::to_string(vertex);
+            return std::nullopt;
+        }
+        affected.emplace_back(vertex);
+    }
+
+    auto solution = cobra::Solution(instance, std::min(instance.get_vertices_num(), parameters.get_solution_cache_size()));
+
+    auto served = std::vector<bool>(instance.get_vertices_num(), false);
+    auto unserved = std::vector<int>();
+
+    for (const auto& customers : delta.routes) {
+
+        auto route = cobra::Solution::dummy_route;
+        auto load = 0;
+
+        for (auto customer : customers) {
+
+            if (!is_customer(customer)) {
+                error = "unknown customer " + std::to_string(customer);
+                return std::nullopt;
+            }
+            if (served[customer]) {
+                error = "customer " + std::to_string(customer) + " is served more than once";
+                return std::nullopt;
+            }
+            served[customer] = true;
+
+            if (load + instance.get_demand(customer) > instance.get_vehicle_capacity()) {
+                unserved.emplace_back(customer);
+                continue;
+            }
+            load += instance.get_demand(customer);
+
+            if (route == cobra::Solution::dummy_route) {
+                route = solution.build_one_customer_route(customer);
+            } else {
+                solution.insert_vertex_before(route, depot, customer);
+            }
+
+        }
+
+    }
+
+    for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+        if (!served[i]) {
+            unserved.emplace_back(i);
+        }
+    }
+
+    auto insertion = BestInsertion(instance, *costs);
+    for (auto customer : unserved) {
+        const auto best = insertion.find_best(solution, customer);
+        if (best.route == cobra::Solution::dummy_route) {
+            solution.build_one_customer_route(customer);
+        } else {
+            solution.insert_vertex_before(best.route, best.where, customer);
+        }
+        affected.emplace_back(customer);
+    }
+
+    if(!round_costs) { solution.recompute_costs(); }
+
+    #ifdef VERBOSE
+    std::cout << "Re-optimizing after " << unserved.size() << " insertions: obj = " << solution.get_cost() << ", n. of routes = " << solution.get_routes_num()
+              << ", " << affected.size() << " affected customers.\n";
+    #endif
+
+    auto reoptimization_parameters = parameters;
+    if (!reoptimization_parameters.set(TOKEN_COREOPT_ITERATIONS, std::to_string(iterations), error)) {
+        return std::nullopt;
+    }
+
+    auto rand_engine = std::mt19937(seed);
+
+    const auto on_best_solution = callbacks.on_best_solution ? &callbacks.on_best_solution : nullptr;
+
+    return coreopt(instance, *costs, reoptimization_parameters, solution, rand_engine, seed_move_generators, mean_arc_cost, round_costs,
+                   std::chrono::high_resolution_clock::now(), nullptr, nullptr, nullptr, &affected, on_best_solution, nullptr, true);
+
+}
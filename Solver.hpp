@@ -0,0 +1,140 @@
+#ifndef FILO__SOLVER_HPP_
+#define FILO__SOLVER_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include "arg_parser.hpp"
+#include "CostTable.hpp"
+#include "checkpoint.hpp"
+#include "Profile.hpp"
+
+inline auto get_basename(const std::string& pathname) -> std::string {
+    return {std::find_if(pathname.rbegin(), pathname.rend(),
+                         [](char c) { return c == '/'; }).base(),
+            pathname.end()};
+}
+
+// Pre-processed instance (mean arc cost, bound on the n. of routes, cost table and move generators) that can be solved
+// from scratch for several seeds, or re-optimized starting from a solution of a slightly different instance, which needs
+// a Solver of its own. The phases of the algorithm are exposed separately, solve() chains them.
+class Solver {
+
+ public:
+
+    enum class Phase {
+        CONSTRUCTION,
+        ROUTE_MINIMIZATION,
+        CORE_OPTIMIZATION
+    };
+
+    struct Callbacks {
+        // invoked by solve() at the end of each phase with the solution it produced
+        std::function<void(Phase, const cobra::Solution&)> on_phase_end;
+        // invoked whenever the main COREOPT trajectory finds a new best solution
+        std::function<void(const cobra::Solution&)> on_best_solution;
+    };
+
+    // Changes of the instance with respect to the one a previous solution was computed for, expressed with the vertex
+    // indices of the current instance.
+    struct Delta {
+        // routes of the previous solution, without the customers which have been removed
+        std::vector<std::vector<int>> routes;
+        // customers whose demand or location has changed and customers which were adjacent to removed ones. Added
+        // customers, i.e. those not in routes, are affected as well.
+        std::vector<int> affected;
+    };
+
+ private:
+
+    const cobra::Instance& instance;
+    const Parameters parameters;
+    const bool round_costs;
+
+    double mean_arc_cost = 0.0;
+    int kmin = 0;
+
+    std::unique_ptr<CostTable> costs;
+    std::unique_ptr<cobra::KNeighborsMoveGeneratorsView> knn_view;
+    std::vector<cobra::AbstractMoveGeneratorsView*> views;
+    std::unique_ptr<cobra::MoveGenerators> move_generators;
+
+    Callbacks callbacks;
+
+    // wall time of the pre-processing steps
+    Profile preprocessing_profile;
+
+ public:
+
+    // Pre-processes instance. A known mean arc cost, e.g. that of a previous version of the instance, skips its O(n^2)
+    // computation, but nothing else is reused: the cost table is built again, which for the full matrix backend (at most
+    // --cost-matrix-max-vertices vertices) is O(n^2) as well, and so are the move generators. The neighbor lists they are
+    // built from are computed by COBRA when the instance is created.
+    Solver(const cobra::Instance& instance_, const Parameters& parameters_, bool round_costs_, std::optional<double> known_mean_arc_cost = std::nullopt);
+
+    double get_mean_arc_cost() const { return mean_arc_cost; }
+    int get_kmin() const { return kmin; }
+    const CostTable& get_costs() const { return *costs; }
+    const Parameters& get_parameters() const { return parameters; }
+    const Profile& get_preprocessing_profile() const { return preprocessing_profile; }
+    std::vector<cobra::AbstractMoveGeneratorsView*>& get_views() { return views; }
+    // move generators used by the solve() overload without seed_move_generators
+    cobra::MoveGenerators& get_move_generators() { return *move_generators; }
+
+    void set_callbacks(Callbacks callbacks_) { callbacks = std::move(callbacks_); }
+
+    // Path of the seed's output file with the given extension, e.g. ".out".
+    std::string get_output_path(int seed, const std::string& extension) const;
+
+    // CLARKE&WRIGHT initial solution.
+    cobra::Solution construct() const;
+
+    // ROUTEMIN, applied only when solution uses more routes than the greedy bound.
+    cobra::Solution minimize_routes(const cobra::Solution& solution, std::mt19937& rand_engine, cobra::MoveGenerators& seed_move_generators);
+
+    // COREOPT on the configured n. of trajectories, with decomposition and checkpointing of the main trajectory when
+    // enabled. When resume is not null, solution must be its current solution. The main trajectory is profiled in profile,
+    // if not null.
+    cobra::Solution optimize(const cobra::Solution& solution, int seed, std::mt19937& rand_engine, cobra::MoveGenerators& seed_move_generators,
+                             std::chrono::high_resolution_clock::time_point time_begin, const checkpoint::State* resume = nullptr,
+                             Profile* profile = nullptr);
+
+    // Runs the per-seed pipeline with the solver's move generators, see below.
+    cobra::Solution solve(int seed, std::chrono::high_resolution_clock::time_point time_begin, const cobra::Solution* initial_solution = nullptr,
+                          const checkpoint::State* resume = nullptr, Profile* profile = nullptr);
+
+    // Runs the per-seed pipeline (CLARKE&WRIGHT, ROUTEMIN and COREOPT) and returns the best solution found. The pipeline
+    // directly continues COREOPT when resume is not null, and starts COREOPT from initial_solution when it is not null.
+    // time_begin is the start of the run, which for a resumed checkpoint includes the checkpointed runtime. The wall time
+    // of each phase is added to profile, if not null. Concurrent calls must use different move generators, see get_views().
+    cobra::Solution solve(int seed, cobra::MoveGenerators& seed_move_generators, std::chrono::high_resolution_clock::time_point time_begin,
+                          const cobra::Solution* initial_solution = nullptr, const checkpoint::State* resume = nullptr, Profile* profile = nullptr);
+
+    // Stores solution and the runtime since time_begin in the seed's .out and .vrp.sol files, and profile, if not null, in
+    // the seed's .profile.json file.
+    void store_results(int seed, const cobra::Solution& solution, std::chrono::high_resolution_clock::time_point time_begin,
+                       const Profile* profile = nullptr) const;
+
+    // Runs reoptimize() below with move generators of its own, built from get_views(), so that it may run concurrently
+    // with solve() and other reoptimize() calls.
+    std::optional<cobra::Solution> reoptimize(const Delta& delta, int seed, int iterations, std::string& error);
+
+    // Repairs the previous solution described by delta and runs a COREOPT of the given iterations focused on the affected
+    // customers. The repair inserts, at their cheapest feasible position, the customers which are not in delta.routes and
+    // those exceeding the capacity of their route after demand changes. Returns std::nullopt, describing the reason in
+    // error, if delta refers to unknown or repeated customers. Concurrent calls must use different move generators, as
+    // for solve().
+    std::optional<cobra::Solution> reoptimize(const Delta& delta, int seed, int iterations, cobra::MoveGenerators& seed_move_generators,
+                                              std::string& error);
+
+};
+
+#endif //FILO__SOLVER_HPP_
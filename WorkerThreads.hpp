@@ -0,0 +1,94 @@
+#ifndef FILO__WORKERTHREADS_HPP_
+#define FILO__WORKERTHREADS_HPP_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads running a task in steps, used by parallel ROUTEMIN and by Decomposition. The threads are started
+// once, by the constructor, and wait for the next step in between: at each step thread t runs task(t) for t in
+// [1, threads_num) while the calling thread runs task(0). The state read by the task is written by the caller before
+// run_step() and the results are read after it returns, the mutex ordering both with respect to the threads.
+class WorkerThreads {
+
+    const std::function<void(int)> task;
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable step_begin;
+    std::condition_variable step_end;
+    long step = 0;
+    int running_threads = 0;
+    bool stopping = false;
+
+    void run(int t) {
+
+        auto last_step = 0l;
+
+        for (;;) {
+
+            {
+                auto lock = std::unique_lock<std::mutex>(mutex);
+                step_begin.wait(lock, [this, last_step]() { return stopping || step != last_step; });
+                if (stopping) { return; }
+                last_step = step;
+            }
+
+            task(t);
+
+            {
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                running_threads--;
+            }
+            step_end.notify_one();
+
+        }
+
+    }
+
+ public:
+
+    WorkerThreads(int threads_num, std::function<void(int)> task_) : task(std::move(task_)) {
+        for (auto t = 1; t < threads_num; t++) {
+            threads.emplace_back([this, t]() { run(t); });
+        }
+    }
+
+    ~WorkerThreads() {
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            stopping = true;
+        }
+        step_begin.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    WorkerThreads(const WorkerThreads&) = delete;
+    WorkerThreads& operator=(const WorkerThreads&) = delete;
+
+    // Runs a step on all the threads, the calling thread included, and returns once all of them have completed it.
+    void run_step() {
+
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex);
+            running_threads = static_cast<int>(threads.size());
+            step++;
+        }
+        step_begin.notify_all();
+
+        task(0);
+
+        {
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            step_end.wait(lock, [this]() { return running_threads == 0; });
+        }
+
+    }
+
+};
+
+#endif //FILO__WORKERTHREADS_HPP_
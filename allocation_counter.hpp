@@ -0,0 +1,18 @@
+#ifndef FILO__ALLOCATION_COUNTER_HPP_
+#define FILO__ALLOCATION_COUNTER_HPP_
+
+#include <atomic>
+
+// Heap allocations counter. When ALLOCATION_COUNTER is defined main.cpp replaces the global operator new with a version
+// that counts its invocations, otherwise the counter stays at zero.
+namespace allocation_counter {
+
+    inline std::atomic<unsigned long> allocations{0};
+
+    inline unsigned long get() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+
+}
+
+#endif //FILO__ALLOCATION_COUNTER_HPP_
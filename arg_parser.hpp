@@ -5,6 +5,12 @@
 #ifndef FILO__ARG_PARSER_HPP_
 #define FILO__ARG_PARSER_HPP_
 
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
 /* Default parameters */
 #define DEFAULT_OUTPATH ("./")
 #define DEFAULT_PARSER ("X")
@@ -12,11 +18,11 @@
 #define DEFAULT_CW_LAMBDA (1.0f)
 #define DEFAULT_CW_NEIGHBORS (100)
 #define DEFAULT_ROUTEMIN_ITERATIONS (1000)
-#ifdef TIMEBASED
-#define DEFAULT_COREOPT_ITERATIONS (60)
-#else
+#define DEFAULT_ROUTEMIN_STAGNATION (0)
+#define DEFAULT_ROUTEMIN_TIME_FRACTION (0.0f)
+#define DEFAULT_ROUTEMIN_THREADS (1)
 #define DEFAULT_COREOPT_ITERATIONS (100000)
-#endif
+#define DEFAULT_TIME_LIMIT (0)
 #define DEFAULT_SPARSIFICATION_RULE1_NEIGHBORS (25)
 #define DEFAULT_SPARSIFICATION_FACTOR (0.25f)
 #define DEFAULT_SPARSIFICATION_MULTIPLIER (0.50f)
@@ -24,6 +30,26 @@
 #define DEFAULT_SHAKING_UB_FACTOR (0.85f)
 #define DEFAULT_TOLERANCE (0.01f)
 #define DEFAULT_SEED (0)
+#define DEFAULT_RECREATE_NEIGHBORS (0)
+#define DEFAULT_FLAT_ROUTES (0)
+#define DEFAULT_COST_MATRIX_MAX_VERTICES (4000)
+#define DEFAULT_THREADS (1)
+#define DEFAULT_MIGRATION_PERIOD (10000)
+#define DEFAULT_DECOMPOSITION_THREADS (0)
+#define DEFAULT_DECOMPOSITION_MIN_CUSTOMERS (10000)
+#define DEFAULT_DECOMPOSITION_PERIOD (1000)
+#define DEFAULT_DECOMPOSITION_ITERATIONS (100)
+#define DEFAULT_PREPROCESSING_THREADS (0)
+#define DEFAULT_MEAN_ARC_COST_SAMPLES (0)
+#define DEFAULT_INSTANCE_CACHE ("")
+#define DEFAULT_NEIGHBOR_CACHE ("")
+#define DEFAULT_BATCH_WORKERS (1)
+#define DEFAULT_CHECKPOINT_PERIOD (0)
+#define DEFAULT_RESUME ("")
+#define DEFAULT_INITIAL_SOLUTION ("")
+#define DEFAULT_WARM_START_TEMPERATURE_FACTOR (0.1f)
+#define DEFAULT_OPERATOR_STATISTICS (0)
+#define DEFAULT_ADAPTIVE_OPERATORS (0)
 
 /* Tokens */
 #define TOKEN_OUTPATH ("--outpath")
@@ -32,16 +58,37 @@
 #define TOKEN_SPARSIFICATION_RULE1_NEIGHBORS ("--granular-neighbors")
 #define TOKEN_SOLUTION_CACHE_HISTORY ("--cache")
 #define TOKEN_ROUTEMIN_ITERATIONS ("--routemin-iterations")
-#ifdef TIMEBASED
-#define TOKEN_COREOPT_ITERATIONS ("--time")
-#else
+#define TOKEN_ROUTEMIN_STAGNATION ("--routemin-stagnation")
+#define TOKEN_ROUTEMIN_TIME_FRACTION ("--routemin-time-fraction")
+#define TOKEN_ROUTEMIN_THREADS ("--routemin-threads")
 #define TOKEN_COREOPT_ITERATIONS ("--coreopt-iterations")
-#endif
+#define TOKEN_TIME_LIMIT ("--time")
 #define TOKEN_SPARSIFICATION_FACTOR ("--granular-gamma-base")
 #define TOKEN_SPARSIFICATION_MULTIPLIER ("--granular-delta")
 #define TOKEN_SHAKING_LB_FACTOR ("--shaking-lower-bound")
 #define TOKEN_SHAKING_UB_FACTOR ("--shaking-upper-bound")
 #define TOKEN_SEED ("--seed")
+#define TOKEN_RECREATE_NEIGHBORS ("--recreate-neighbors")
+#define TOKEN_FLAT_ROUTES ("--flat-routes")
+#define TOKEN_COST_MATRIX_MAX_VERTICES ("--cost-matrix-max-vertices")
+#define TOKEN_THREADS ("--threads")
+#define TOKEN_MIGRATION_PERIOD ("--migration-period")
+#define TOKEN_DECOMPOSITION_THREADS ("--decomposition-threads")
+#define TOKEN_DECOMPOSITION_MIN_CUSTOMERS ("--decomposition-min-customers")
+#define TOKEN_DECOMPOSITION_PERIOD ("--decomposition-period")
+#define TOKEN_DECOMPOSITION_ITERATIONS ("--decomposition-iterations")
+#define TOKEN_PREPROCESSING_THREADS ("--preprocessing-threads")
+#define TOKEN_MEAN_ARC_COST_SAMPLES ("--mean-arc-cost-samples")
+#define TOKEN_INSTANCE_CACHE ("--instance-cache")
+#define TOKEN_NEIGHBOR_CACHE ("--neighbor-cache")
+#define TOKEN_SEEDS ("--seeds")
+#define TOKEN_BATCH_WORKERS ("--batch-workers")
+#define TOKEN_CHECKPOINT_PERIOD ("--checkpoint-period")
+#define TOKEN_RESUME ("--resume")
+#define TOKEN_INITIAL_SOLUTION ("--initial-solution")
+#define TOKEN_WARM_START_TEMPERATURE_FACTOR ("--warm-start-temperature-factor")
+#define TOKEN_OPERATOR_STATISTICS ("--operator-statistics")
+#define TOKEN_ADAPTIVE_OPERATORS ("--adaptive-operators")
 #define TOKEN_HELP ("--help")
 
 class Parameters {
@@ -56,13 +103,43 @@ class Parameters {
     float cw_lambda = DEFAULT_CW_LAMBDA;
     int cw_neighbors = DEFAULT_CW_NEIGHBORS;
     int routemin_iterations = DEFAULT_ROUTEMIN_ITERATIONS;
+    int routemin_stagnation = DEFAULT_ROUTEMIN_STAGNATION;
+    float routemin_time_fraction = DEFAULT_ROUTEMIN_TIME_FRACTION;
+    int routemin_threads = DEFAULT_ROUTEMIN_THREADS;
     int coreopt_iterations = DEFAULT_COREOPT_ITERATIONS;
+    // when only a time limit is given the n. of iterations is unbounded
+    bool coreopt_iterations_given = false;
+    int time_limit = DEFAULT_TIME_LIMIT;
     int sparsification_rule_neighbors = DEFAULT_SPARSIFICATION_RULE1_NEIGHBORS;
     float gamma_base = DEFAULT_SPARSIFICATION_FACTOR;
     float delta = DEFAULT_SPARSIFICATION_MULTIPLIER;
     float shaking_lb_factor = DEFAULT_SHAKING_LB_FACTOR;
     float shaking_ub_factor = DEFAULT_SHAKING_UB_FACTOR;
     int seed = DEFAULT_SEED;
+    int recreate_neighbors = DEFAULT_RECREATE_NEIGHBORS;
+    bool flat_routes = DEFAULT_FLAT_ROUTES;
+    int cost_matrix_max_vertices = DEFAULT_COST_MATRIX_MAX_VERTICES;
+    int threads = DEFAULT_THREADS;
+    int migration_period = DEFAULT_MIGRATION_PERIOD;
+    int decomposition_threads = DEFAULT_DECOMPOSITION_THREADS;
+    int decomposition_min_customers = DEFAULT_DECOMPOSITION_MIN_CUSTOMERS;
+    int decomposition_period = DEFAULT_DECOMPOSITION_PERIOD;
+    int decomposition_iterations = DEFAULT_DECOMPOSITION_ITERATIONS;
+    int preprocessing_threads = DEFAULT_PREPROCESSING_THREADS;
+    int mean_arc_cost_samples = DEFAULT_MEAN_ARC_COST_SAMPLES;
+    std::string instance_cache = DEFAULT_INSTANCE_CACHE;
+    std::string neighbor_cache = DEFAULT_NEIGHBOR_CACHE;
+    // inclusive range of seeds run in batch mode, when not given only seed is run
+    bool seeds_range = false;
+    int seeds_begin = DEFAULT_SEED;
+    int seeds_end = DEFAULT_SEED;
+    int batch_workers = DEFAULT_BATCH_WORKERS;
+    int checkpoint_period = DEFAULT_CHECKPOINT_PERIOD;
+    std::string resume = DEFAULT_RESUME;
+    std::string initial_solution = DEFAULT_INITIAL_SOLUTION;
+    float warm_start_temperature_factor = DEFAULT_WARM_START_TEMPERATURE_FACTOR;
+    bool operator_statistics = DEFAULT_OPERATOR_STATISTICS;
+    bool adaptive_operators = DEFAULT_ADAPTIVE_OPERATORS;
 
  public:
 
@@ -80,9 +157,24 @@ class Parameters {
     int get_routemin_iterations() const {
         return routemin_iterations;
     }
+    int get_routemin_stagnation() const {
+        return routemin_stagnation;
+    }
+    float get_routemin_time_fraction() const {
+        return routemin_time_fraction;
+    }
+    int get_routemin_threads() const {
+        return routemin_threads;
+    }
     int get_coreopt_iterations() const {
+        if (time_limit > 0 && !coreopt_iterations_given) {
+            return std::numeric_limits<int>::max();
+        }
         return coreopt_iterations;
     }
+    int get_time_limit() const {
+        return time_limit;
+    }
     int get_sparsification_rule_neighbors() const {
         return sparsification_rule_neighbors;
     }
@@ -105,47 +197,150 @@ class Parameters {
     std::string get_outpath() const { return outpath; }
     std::string get_parser() const { return parser; }
     int get_seed() const { return seed; }
-
-    void set(std::string key, std::string value) {
-
-        if(key == TOKEN_OUTPATH) {
-            outpath = value;
-            if(outpath.back() != '/') {
-                outpath += '/';
+    int get_recreate_neighbors() const { return recreate_neighbors; }
+    bool get_flat_routes() const { return flat_routes; }
+    int get_cost_matrix_max_vertices() const { return cost_matrix_max_vertices; }
+    int get_threads() const { return threads; }
+    int get_migration_period() const { return migration_period; }
+    int get_decomposition_threads() const { return decomposition_threads; }
+    int get_decomposition_min_customers() const { return decomposition_min_customers; }
+    int get_decomposition_period() const { return decomposition_period; }
+    int get_decomposition_iterations() const { return decomposition_iterations; }
+    int get_preprocessing_threads() const { return preprocessing_threads; }
+    int get_mean_arc_cost_samples() const { return mean_arc_cost_samples; }
+    std::string get_instance_cache() const { return instance_cache; }
+    std::string get_neighbor_cache() const { return neighbor_cache; }
+    int get_seeds_begin() const { return seeds_range ? seeds_begin : seed; }
+    int get_seeds_end() const { return seeds_range ? seeds_end : seed; }
+    int get_batch_workers() const { return batch_workers; }
+    int get_checkpoint_period() const { return checkpoint_period; }
+    std::string get_resume() const { return resume; }
+    std::string get_initial_solution() const { return initial_solution; }
+    float get_warm_start_temperature_factor() const { return warm_start_temperature_factor; }
+    bool get_operator_statistics() const { return operator_statistics; }
+    bool get_adaptive_operators() const { return adaptive_operators; }
+
+    // Sets the parameter identified by key, i.e. its command line token, to value. Returns false, describing the reason
+    // in error, if key is unknown or value is invalid.
+    bool set(const std::string& key, const std::string& value, std::string& error) {
+
+        try {
+
+            if(key == TOKEN_OUTPATH) {
+                outpath = value;
+                if(outpath.back() != '/') {
+                    outpath += '/';
+                }
+            } else if (key == TOKEN_PARSER) {
+                parser = value;
+            } else if (key == TOKEN_TOLERANCE) {
+                tolerance = std::stof(value);
+            } else if (key == TOKEN_SPARSIFICATION_RULE1_NEIGHBORS) {
+                sparsification_rule_neighbors = std::stoi(value);
+            } else if (key == TOKEN_SOLUTION_CACHE_HISTORY) {
+                solution_cache_history = std::stoi(value);
+            } else if (key == TOKEN_ROUTEMIN_ITERATIONS) {
+                routemin_iterations = std::stoi(value);
+            } else if (key == TOKEN_ROUTEMIN_STAGNATION) {
+                routemin_stagnation = std::stoi(value);
+            } else if (key == TOKEN_ROUTEMIN_TIME_FRACTION) {
+                routemin_time_fraction = std::stof(value);
+            } else if (key == TOKEN_ROUTEMIN_THREADS) {
+                routemin_threads = std::stoi(value);
+            } else if (key == TOKEN_COREOPT_ITERATIONS){
+                coreopt_iterations = std::stoi(value);
+                coreopt_iterations_given = true;
+            } else if (key == TOKEN_TIME_LIMIT) {
+                time_limit = std::stoi(value);
+            } else if (key == TOKEN_SPARSIFICATION_FACTOR) {
+                gamma_base = std::stof(value);
+            } else if (key == TOKEN_SPARSIFICATION_MULTIPLIER){
+                delta = std::stof(value);
+            } else if (key == TOKEN_SHAKING_LB_FACTOR){
+                shaking_lb_factor = std::stof(value);
+            } else if (key == TOKEN_SHAKING_UB_FACTOR) {
+                shaking_ub_factor = std::stof(value);
+            } else if (key == TOKEN_SEED) {
+                seed = std::stoi(value);
+            } else if (key == TOKEN_RECREATE_NEIGHBORS) {
+                recreate_neighbors = std::stoi(value);
+            } else if (key == TOKEN_FLAT_ROUTES) {
+                flat_routes = std::stoi(value) != 0;
+            } else if (key == TOKEN_COST_MATRIX_MAX_VERTICES) {
+                cost_matrix_max_vertices = std::stoi(value);
+            } else if (key == TOKEN_THREADS) {
+                threads = std::stoi(value);
+            } else if (key == TOKEN_MIGRATION_PERIOD) {
+                migration_period = std::max(1, std::stoi(value));
+            } else if (key == TOKEN_DECOMPOSITION_THREADS) {
+                decomposition_threads = std::stoi(value);
+            } else if (key == TOKEN_DECOMPOSITION_MIN_CUSTOMERS) {
+                decomposition_min_customers = std::stoi(value);
+            } else if (key == TOKEN_DECOMPOSITION_PERIOD) {
+                decomposition_period = std::max(1, std::stoi(value));
+            } else if (key == TOKEN_DECOMPOSITION_ITERATIONS) {
+                decomposition_iterations = std::stoi(value);
+            } else if (key == TOKEN_PREPROCESSING_THREADS) {
+                preprocessing_threads = std::stoi(value);
+            } else if (key == TOKEN_MEAN_ARC_COST_SAMPLES) {
+                mean_arc_cost_samples = std::stoi(value);
+            } else if (key == TOKEN_INSTANCE_CACHE) {
+                instance_cache = value;
+                if(!instance_cache.empty() && instance_cache.back() != '/') {
+                    instance_cache += '/';
+                }
+            } else if (key == TOKEN_NEIGHBOR_CACHE) {
+                neighbor_cache = value;
+                if(!neighbor_cache.empty() && neighbor_cache.back() != '/') {
+                    neighbor_cache += '/';
+                }
+            } else if (key == TOKEN_SEEDS) {
+                const auto separator = value.find("..");
+                if (separator == std::string::npos) {
+                    error = "invalid seeds range '" + value + "', expected A..B";
+                    return false;
+                }
+                seeds_begin = std::stoi(value.substr(0, separator));
+                seeds_end = std::stoi(value.substr(separator + 2));
+                if (seeds_end < seeds_begin) {
+                    error = "invalid seeds range '" + value + "', expected A <= B";
+                    return false;
+                }
+                seeds_range = true;
+                seed = seeds_begin;
+            } else if (key == TOKEN_BATCH_WORKERS) {
+                batch_workers = std::stoi(value);
+            } else if (key == TOKEN_CHECKPOINT_PERIOD) {
+                checkpoint_period = std::stoi(value);
+            } else if (key == TOKEN_RESUME) {
+                resume = value;
+            } else if (key == TOKEN_INITIAL_SOLUTION) {
+                initial_solution = value;
+            } else if (key == TOKEN_WARM_START_TEMPERATURE_FACTOR) {
+                warm_start_temperature_factor = std::stof(value);
+            } else if (key == TOKEN_OPERATOR_STATISTICS) {
+                operator_statistics = std::stoi(value) != 0;
+            } else if (key == TOKEN_ADAPTIVE_OPERATORS) {
+                adaptive_operators = std::stoi(value) != 0;
+            } else {
+                error = "unknown argument '" + key + "'";
+                return false;
             }
-        } else if (key == TOKEN_PARSER) {
-            parser = value;
-        } else if (key == TOKEN_TOLERANCE) {
-            tolerance = std::stof(value);
-        } else if (key == TOKEN_SPARSIFICATION_RULE1_NEIGHBORS) {
-            sparsification_rule_neighbors = std::stoi(value);
-        } else if (key == TOKEN_SOLUTION_CACHE_HISTORY) {
-            solution_cache_history = std::stoi(value);
-        } else if (key == TOKEN_ROUTEMIN_ITERATIONS) {
-            routemin_iterations = std::stoi(value);
-        } else if (key == TOKEN_COREOPT_ITERATIONS){
-            coreopt_iterations = std::stoi(value);
-        } else if (key == TOKEN_SPARSIFICATION_FACTOR) {
-            gamma_base = std::stof(value);
-        } else if (key == TOKEN_SPARSIFICATION_MULTIPLIER){
-            delta = std::stof(value);
-        } else if (key == TOKEN_SHAKING_LB_FACTOR){
-            shaking_lb_factor = std::stof(value);
-        } else if (key == TOKEN_SHAKING_UB_FACTOR) {
-            shaking_ub_factor = std::stof(value);
-        } else if (key == TOKEN_SEED) {
-            seed = std::stoi(value);
-        } else {
-            std::cout << "Error: unknown argument '" << key <<"'. Try --help for more information.\n";
-            exit(EXIT_SUCCESS);
+
+        } catch (const std::logic_error&) {
+            // std::invalid_argument and std::out_of_range thrown by the numeric conversions
+            error = "invalid value '" + value + "' for '" + key + "'";
+            return false;
         }
 
+        return true;
+
     }
 
 
 };
 
-void print_help() {
+inline void print_help() {
 
     std::cout << "Usage: filo <path-to-instance> [OPTIONS]\n\n";
 
@@ -157,22 +352,43 @@ void print_help() {
     std::cout << TOKEN_SPARSIFICATION_RULE1_NEIGHBORS << " INT\tNeighbors per vertex in granular neighborhoods (default: "<<DEFAULT_SPARSIFICATION_RULE1_NEIGHBORS << ")\n";
     std::cout << TOKEN_SOLUTION_CACHE_HISTORY << " INT\t\t\tSelective cache dimension (default: " << DEFAULT_SOLUTION_CACHE_HISTORY <<")\n";
     std::cout << TOKEN_ROUTEMIN_ITERATIONS << " INT\tMax route minimization iterations (default: " << DEFAULT_ROUTEMIN_ITERATIONS << ")\n";
-    #ifdef TIMEBASED
-    std::cout << TOKEN_COREOPT_ITERATIONS << " INT\t\t\tRuntime in seconds (default: " << DEFAULT_COREOPT_ITERATIONS << ")\n";
-    #else
-    std::cout << TOKEN_COREOPT_ITERATIONS << " INT\tCore optimization iterations (default: " << DEFAULT_COREOPT_ITERATIONS << ")\n";
-    #endif
+    std::cout << TOKEN_ROUTEMIN_STAGNATION << " INT\tMax route minimization iterations without reducing the n. of routes, 0 to disable (default: " << DEFAULT_ROUTEMIN_STAGNATION << ")\n";
+    std::cout << TOKEN_ROUTEMIN_THREADS << " INT\tConcurrent route elimination attempts per route minimization iteration (default: " << DEFAULT_ROUTEMIN_THREADS << ")\n";
+    std::cout << TOKEN_ROUTEMIN_TIME_FRACTION << " FLOAT\tMax route minimization time as a fraction of " << TOKEN_TIME_LIMIT << ", 0 to disable (default: " << DEFAULT_ROUTEMIN_TIME_FRACTION << ")\n";
+    std::cout << TOKEN_COREOPT_ITERATIONS << " INT\tCore optimization iterations, unbounded if only " << TOKEN_TIME_LIMIT << " is given (default: " << DEFAULT_COREOPT_ITERATIONS << ")\n";
+    std::cout << TOKEN_TIME_LIMIT << " INT\t\t\tRuntime in seconds, 0 for no limit, COREOPT stops at the first limit reached (default: " << DEFAULT_TIME_LIMIT << ")\n";
     std::cout << TOKEN_SPARSIFICATION_FACTOR << " FLOAT\tInitial sparsification factor gamma base (default: " << DEFAULT_SPARSIFICATION_FACTOR << ")\n";
     std::cout << TOKEN_SPARSIFICATION_MULTIPLIER << " FLOAT\t\tGranular reduction factor delta (default: " << DEFAULT_SPARSIFICATION_MULTIPLIER << ")\n";
     std::cout << TOKEN_SHAKING_LB_FACTOR << " FLOAT\tShaking lower bound factor (default: " << DEFAULT_SHAKING_LB_FACTOR << ")\n";
     std::cout << TOKEN_SHAKING_UB_FACTOR << " FLOAT\tShaking upper bound factor (default: " << DEFAULT_SHAKING_UB_FACTOR << ")\n";
     std::cout << TOKEN_SEED << " INT\t\t\tSeed (default: " << DEFAULT_SEED << ")\n";
+    std::cout << TOKEN_RECREATE_NEIGHBORS << " INT\tNeighbors evaluated when reinserting ruined customers, a new route is opened when none of their routes fits, 0 for an exhaustive scan (default: " << DEFAULT_RECREATE_NEIGHBORS << ")\n";
+    std::cout << TOKEN_FLAT_ROUTES << " INT\t\tKeep contiguous copies of the routes while reinserting customers, 0 or 1 (default: " << DEFAULT_FLAT_ROUTES << ")\n";
+    std::cout << TOKEN_COST_MATRIX_MAX_VERTICES << " INT\tMax n. of vertices to store the full cost matrix, larger instances use a sparse table (default: " << DEFAULT_COST_MATRIX_MAX_VERTICES << ")\n";
+    std::cout << TOKEN_THREADS << " INT\t\t\tConcurrent COREOPT trajectories (default: " << DEFAULT_THREADS << ")\n";
+    std::cout << TOKEN_MIGRATION_PERIOD << " INT\tIterations between best solution exchanges among trajectories (default: " << DEFAULT_MIGRATION_PERIOD << ")\n";
+    std::cout << TOKEN_DECOMPOSITION_THREADS << " INT\tConcurrent clusters re-optimized by decomposition, 0 to disable (default: " << DEFAULT_DECOMPOSITION_THREADS << ")\n";
+    std::cout << TOKEN_DECOMPOSITION_MIN_CUSTOMERS << " INT\tMin n. of customers to enable decomposition (default: " << DEFAULT_DECOMPOSITION_MIN_CUSTOMERS << ")\n";
+    std::cout << TOKEN_DECOMPOSITION_PERIOD << " INT\tCOREOPT iterations between decomposition steps (default: " << DEFAULT_DECOMPOSITION_PERIOD << ")\n";
+    std::cout << TOKEN_DECOMPOSITION_ITERATIONS << " INT\tIterations per cluster in a decomposition step (default: " << DEFAULT_DECOMPOSITION_ITERATIONS << ")\n";
+    std::cout << TOKEN_PREPROCESSING_THREADS << " INT\tThreads used by pre-processing, 0 for all hardware threads (default: " << DEFAULT_PREPROCESSING_THREADS << ")\n";
+    std::cout << TOKEN_MEAN_ARC_COST_SAMPLES << " INT\tArcs sampled to estimate the mean arc cost, 0 for the exact value (default: " << DEFAULT_MEAN_ARC_COST_SAMPLES << ")\n";
+    std::cout << TOKEN_SEEDS << " A..B\t\t\tRun all seeds from A to B (included) reusing the pre-processing, overrides " << TOKEN_SEED << "\n";
+    std::cout << TOKEN_BATCH_WORKERS << " INT\t\tSeeds run concurrently by " << TOKEN_SEEDS << " (default: " << DEFAULT_BATCH_WORKERS << ")\n";
+    std::cout << TOKEN_CHECKPOINT_PERIOD << " INT\tSeconds between checkpoints of COREOPT and of the best solution, 0 to disable (default: " << DEFAULT_CHECKPOINT_PERIOD << ")\n";
+    std::cout << TOKEN_RESUME << " STRING\t\tCheckpoint file to continue COREOPT from, empty to start from scratch (default: \"" << DEFAULT_RESUME << "\")\n";
+    std::cout << TOKEN_INITIAL_SOLUTION << " STRING\tSolution file (.vrp.sol) COREOPT starts from instead of CLARKE&WRIGHT and ROUTEMIN, empty to disable (default: \"" << DEFAULT_INITIAL_SOLUTION << "\")\n";
+    std::cout << TOKEN_WARM_START_TEMPERATURE_FACTOR << " FLOAT\tScaling of the initial annealing temperature when starting from " << TOKEN_INITIAL_SOLUTION << " (default: " << DEFAULT_WARM_START_TEMPERATURE_FACTOR << ")\n";
+    std::cout << TOKEN_OPERATOR_STATISTICS << " INT\tCollect per operator local search statistics in COREOPT, 0 or 1 (default: " << DEFAULT_OPERATOR_STATISTICS << ")\n";
+    std::cout << TOKEN_ADAPTIVE_OPERATORS << " INT\tSkip and reorder local search operators based on their recent improvement per second, 0 or 1 (default: " << DEFAULT_ADAPTIVE_OPERATORS << ")\n";
+    std::cout << TOKEN_INSTANCE_CACHE << " STRING\tDirectory caching instance pre-processing and a binary conversion of the instance across runs, empty to disable (default: \"" << DEFAULT_INSTANCE_CACHE << "\")\n";
+    std::cout << TOKEN_NEIGHBOR_CACHE << " STRING\tDirectory caching the cost table built from the neighbor lists across runs, empty to disable (default: \"" << DEFAULT_NEIGHBOR_CACHE << "\")\n";
 
     std::cout << "\nReport bugs to luca.accorsi4 and the domain is unibo.it\n";
 
 }
 
-Parameters parse_command_line_arguments(int argc, char* argv[]) {
+inline Parameters parse_command_line_arguments(int argc, char* argv[]) {
 
     if(argc == 1) {
         std::cout << "Missing input instance.\n\n";
@@ -205,7 +421,11 @@ Parameters parse_command_line_arguments(int argc, char* argv[]) {
 
 
 
-        parameters.set(token, value);
+        auto error = std::string();
+        if (!parameters.set(token, value, error)) {
+            std::cout << "Error: " << error << ". Try --help for more information.\n";
+            exit(EXIT_FAILURE);
+        }
 
     }
 
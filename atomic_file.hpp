@@ -0,0 +1,57 @@
+#ifndef FILO__ATOMIC_FILE_HPP_
+#define FILO__ATOMIC_FILE_HPP_
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+// Files written to a temporary file which is then renamed, so that readers always find either the previous or the new
+// complete content. Temporary names are unique per process and thread, so that concurrent writers of the same path, e.g.
+// two runs sharing an output or cache directory, never write to the same temporary file.
+namespace atomic_file {
+
+    inline std::string get_temporary_path(const std::string& path) {
+        auto stream = std::ostringstream();
+        stream << path << ".tmp" << getpid() << "-" << std::this_thread::get_id();
+        return stream.str();
+    }
+
+    // Renames tmp_path, a complete temporary file for path, to path. The temporary file is removed on failure.
+    inline bool commit(const std::string& tmp_path, const std::string& path) {
+        auto error = std::error_code();
+        std::filesystem::rename(tmp_path, path, error);
+        if (error) {
+            std::filesystem::remove(tmp_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    // Writes path by calling write(std::ofstream&) on a temporary file. Returns whether path has been written.
+    template <typename Writer>
+    bool write(const std::string& path, std::ios::openmode mode, Writer write) {
+
+        const auto tmp_path = get_temporary_path(path);
+
+        {
+            auto stream = std::ofstream(tmp_path, mode);
+            if (!stream) { return false; }
+            write(stream);
+            if (!stream) {
+                stream.close();
+                auto error = std::error_code();
+                std::filesystem::remove(tmp_path, error);
+                return false;
+            }
+        }
+
+        return commit(tmp_path, path);
+
+    }
+
+}
+
+#endif //FILO__ATOMIC_FILE_HPP_
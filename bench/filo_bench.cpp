@@ -0,0 +1,341 @@
+// End-to-end benchmark: runs FILO on a fixed matrix of X and B instances of increasing size and a few seeds, with fixed
+// iteration budgets, and stores throughput, memory and quality metrics in a csv file. When a baseline (a csv file stored
+// by a previous run) is given, a csv comparison of each metric is also stored, and a summary is printed.
+//
+// Usage: filo_bench <path-to-instances> [--outpath DIR] [--results DIR] [--baseline FILE] [filo options]
+// The instances directory is expected to contain the X and B folders, as in cobra/instances. Additional filo options,
+// e.g. --adaptive-operators 1, are forwarded to every run.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/resource.h>
+#include <cobra/Instance.hpp>
+#include "arg_parser.hpp"
+#include "Solver.hpp"
+#include "Profile.hpp"
+
+namespace {
+
+    struct BenchInstance {
+        // folder below the instances path
+        const char* dataset;
+        const char* name;
+        // results folder holding the reference summary.csv
+        const char* summary;
+    };
+
+    // sorted by size, so that the peak RSS after each instance is (almost always) due to that instance
+    const BenchInstance bench_instances[] = {
+        {"X", "X-n101-k25.vrp", "x"},
+        {"X", "X-n502-k39.vrp", "x"},
+        {"X", "X-n1001-k43.vrp", "x"},
+        {"B", "Leuven1.txt", "b"},
+        {"B", "Antwerp1.txt", "b"},
+        {"B", "Brussels1.txt", "b"},
+    };
+
+    constexpr int bench_seeds = 3;
+    constexpr auto bench_routemin_iterations = "1000";
+    constexpr auto bench_coreopt_iterations = "10000";
+
+    // phases reported for every run, see Solver
+    const char* bench_phases[] = {
+        "parse", "mean_arc_cost", "greedy_routes_bound", "cost_table", "move_generators", "clarke_and_wright", "routemin", "coreopt"
+    };
+
+    struct Run {
+        std::string instance;
+        int seed = 0;
+        std::vector<std::pair<std::string, double>> metrics;
+    };
+
+    // Peak resident set size of the process in KB, as reported by Linux.
+    long get_peak_rss_kb() {
+        auto usage = rusage();
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+    }
+
+    // Best value among the stored seeds of instance in the given summary.csv, or NaN if not available. Summaries hold a
+    // block of objective values (columns z0, z1, ...) followed by a block of runtimes (columns t0, t1, ...).
+    double get_reference_cost(const std::string& summary_path, const std::string& instance) {
+
+        auto stream = std::ifstream(summary_path);
+        auto costs_block = false;
+        for (auto line = std::string(); std::getline(stream, line);) {
+
+            auto fields = std::istringstream(line);
+            auto field = std::string();
+            if (!std::getline(fields, field, ',')) { continue; }
+
+            if (field == "instance") {
+                costs_block = std::getline(fields, field, ',') && field.rfind('z', 0) == 0;
+                continue;
+            }
+            if (!costs_block || field != instance) { continue; }
+
+            auto best = std::numeric_limits<double>::infinity();
+            while (std::getline(fields, field, ',')) {
+                best = std::min(best, std::stod(field));
+            }
+            return best;
+
+        }
+
+        return std::nan("");
+
+    }
+
+    void store_runs(const std::string& path, const std::vector<Run>& runs) {
+
+        auto stream = std::ofstream(path);
+        stream.precision(std::numeric_limits<double>::max_digits10);
+
+        stream << "instance,seed";
+        for (const auto& [name, value] : runs.front().metrics) {
+            stream << "," << name;
+        }
+        stream << "\n";
+
+        for (const auto& run : runs) {
+            stream << run.instance << "," << run.seed;
+            for (const auto& [name, value] : run.metrics) {
+                stream << "," << value;
+            }
+            stream << "\n";
+        }
+
+    }
+
+    bool load_runs(const std::string& path, std::vector<Run>& runs) {
+
+        auto stream = std::ifstream(path);
+        auto line = std::string();
+        if (!std::getline(stream, line)) { return false; }
+
+        auto names = std::vector<std::string>();
+        auto header = std::istringstream(line);
+        for (auto field = std::string(); std::getline(header, field, ',');) {
+            names.emplace_back(field);
+        }
+        if (names.size() < 2 || names[0] != "instance" || names[1] != "seed") { return false; }
+
+        while (std::getline(stream, line)) {
+            auto fields = std::istringstream(line);
+            auto field = std::string();
+            auto run = Run();
+            std::getline(fields, run.instance, ',');
+            std::getline(fields, field, ',');
+            run.seed = std::stoi(field);
+            for (auto n = 2u; n < names.size() && std::getline(fields, field, ','); n++) {
+                run.metrics.emplace_back(names[n], std::stod(field));
+            }
+            runs.emplace_back(std::move(run));
+        }
+
+        return true;
+
+    }
+
+    // Stores one "instance,seed,metric,baseline,current,change_percent" line per metric of the runs found in both
+    // baseline and current, and prints the overall changes of the main metrics.
+    void compare(const std::string& path, const std::vector<Run>& baseline, const std::vector<Run>& current) {
+
+        auto stream = std::ofstream(path);
+        stream.precision(std::numeric_limits<double>::max_digits10);
+        stream << "instance,seed,metric,baseline,current,change_percent\n";
+
+        // overall change of each metric: geometric mean of the current / baseline ratios
+        auto log_ratios = std::map<std::string, std::pair<double, int>>();
+
+        for (const auto& run : current) {
+
+            const auto other = std::find_if(baseline.begin(), baseline.end(), [&run](const Run& b) {
+                return b.instance == run.instance && b.seed == run.seed;
+            });
+            if (other == baseline.end()) { continue; }
+
+            for (const auto& [name, value] : run.metrics) {
+
+                const auto metric = std::find_if(other->metrics.begin(), other->metrics.end(), [&name](const auto& m) { return m.first == name; });
+                if (metric == other->metrics.end()) { continue; }
+
+                const auto base = metric->second;
+                const auto change = base != 0.0 ? 100.0 * (value - base) / base : 0.0;
+                stream << run.instance << "," << run.seed << "," << name << "," << base << "," << value << "," << change << "\n";
+
+                if (base > 0.0 && value > 0.0) {
+                    auto& [sum, count] = log_ratios[name];
+                    sum += std::log(value / base);
+                    count++;
+                }
+
+            }
+
+        }
+
+        std::cout << "\nComparison with the baseline (geometric mean of current / baseline):\n";
+        for (const auto name : {"cost", "peak_rss_kb", "coreopt_iterations_per_second", "decomposition_cluster_iterations_per_second", "total_seconds"}) {
+            const auto entry = log_ratios.find(name);
+            if (entry == log_ratios.end()) { continue; }
+            const auto [sum, count] = entry->second;
+            std::cout << " - " << name << ": " << std::exp(sum / count) << "\n";
+        }
+        std::cout << "Details stored in " << path << "\n";
+
+    }
+
+}
+
+auto main(int argc, char* argv[]) -> int {
+
+    if (argc < 2 || std::string(argv[1]) == TOKEN_HELP) {
+        std::cout << "Usage: filo_bench <path-to-instances> [--outpath DIR] [--results DIR] [--baseline FILE] [filo options]\n";
+        return argc < 2 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    const auto instances_path = std::filesystem::path(argv[1]);
+    auto outpath = std::string("bench-results/");
+    auto results_path = std::filesystem::path("results");
+    auto baseline_path = std::string();
+    auto filo_options = std::vector<std::pair<std::string, std::string>>();
+
+    for (auto n = 2; n < argc; n += 2) {
+
+        const auto token = std::string(argv[n]);
+        if (n + 1 >= argc) {
+            std::cout << "Missing value for '" << token << "'.\n";
+            return EXIT_FAILURE;
+        }
+        const auto value = std::string(argv[n + 1]);
+
+        if (token == TOKEN_OUTPATH) {
+            outpath = value.back() == '/' ? value : value + '/';
+        } else if (token == "--results") {
+            results_path = value;
+        } else if (token == "--baseline") {
+            baseline_path = value;
+        } else {
+            filo_options.emplace_back(token, value);
+        }
+
+    }
+
+    std::filesystem::create_directories(outpath);
+
+    auto runs = std::vector<Run>();
+
+    for (const auto& bench_instance : bench_instances) {
+
+        const auto instance_path = (instances_path / bench_instance.dataset / bench_instance.name).string();
+
+        auto parameters = Parameters(instance_path);
+        auto error = std::string();
+        auto valid_parameters = parameters.set(TOKEN_OUTPATH, outpath, error) &&
+                                parameters.set(TOKEN_ROUTEMIN_ITERATIONS, bench_routemin_iterations, error) &&
+                                parameters.set(TOKEN_COREOPT_ITERATIONS, bench_coreopt_iterations, error);
+        for (auto n = 0u; n < filo_options.size() && valid_parameters; n++) {
+            valid_parameters = parameters.set(filo_options[n].first, filo_options[n].second, error);
+        }
+        if (!valid_parameters) {
+            std::cout << "Error: " << error << ".\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "Running " << bench_instance.name << std::flush;
+
+        const auto parse_begin = std::chrono::high_resolution_clock::now();
+        const auto maybe_instance = cobra::Instance::make<cobra::XInstanceParser, true>(instance_path);
+        if (!maybe_instance) {
+            std::cout << ": unable to parse '" << instance_path << "', skipped.\n";
+            continue;
+        }
+        const auto& instance = maybe_instance.value();
+        const auto parse_seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - parse_begin).count();
+
+        auto solver = Solver(instance, parameters, true);
+
+        const auto reference_cost = get_reference_cost((results_path / bench_instance.summary / "summary.csv").string(), bench_instance.name);
+
+        for (auto seed = 0; seed < bench_seeds; seed++) {
+
+            auto profile = Profile();
+            profile.add_phase("parse", parse_seconds);
+            profile.add_preprocessing(solver.get_preprocessing_profile());
+
+            const auto time_begin = std::chrono::high_resolution_clock::now();
+            const auto solution = solver.solve(seed, time_begin, nullptr, nullptr, &profile);
+
+            auto run = Run();
+            run.instance = bench_instance.name;
+            run.seed = seed;
+
+            run.metrics.emplace_back("customers", instance.get_customers_num());
+            run.metrics.emplace_back("cost", solution.get_cost());
+            run.metrics.emplace_back("routes", solution.get_routes_num());
+            run.metrics.emplace_back("gap_percent", 100.0 * (solution.get_cost() - reference_cost) / reference_cost);
+            run.metrics.emplace_back("peak_rss_kb", get_peak_rss_kb());
+            run.metrics.emplace_back("cost_table_memory_bytes", static_cast<double>(profile.get_cost_table().memory_bytes));
+
+            auto total_seconds = 0.0;
+            for (const auto phase : bench_phases) {
+                const auto& phases = profile.get_phases();
+                const auto entry = std::find_if(phases.begin(), phases.end(), [phase](const auto& p) { return p.first == phase; });
+                const auto seconds = entry != phases.end() ? entry->second : 0.0;
+                run.metrics.emplace_back(std::string(phase) + "_seconds", seconds);
+                total_seconds += seconds;
+            }
+            run.metrics.emplace_back("total_seconds", total_seconds);
+
+            const auto& coreopt = profile.get_coreopt();
+            const auto coreopt_seconds = coreopt.migration_and_decomposition_seconds + coreopt.shaking_seconds + coreopt.local_search_seconds +
+                                         coreopt.bookkeeping_seconds;
+            run.metrics.emplace_back("coreopt_iterations_per_second", coreopt_seconds > 0.0 ? static_cast<double>(coreopt.iterations) / coreopt_seconds : 0.0);
+            run.metrics.emplace_back("coreopt_shaking_seconds", coreopt.shaking_seconds);
+            run.metrics.emplace_back("coreopt_local_search_seconds", coreopt.local_search_seconds);
+            run.metrics.emplace_back("coreopt_bookkeeping_seconds", coreopt.bookkeeping_seconds);
+            run.metrics.emplace_back("decomposition_cluster_iterations_per_second", coreopt.decomposition_seconds > 0.0 ?
+                                     static_cast<double>(coreopt.decomposition_cluster_iterations) / coreopt.decomposition_seconds : 0.0);
+
+            runs.emplace_back(std::move(run));
+
+            std::cout << "." << std::flush;
+
+        }
+
+        std::cout << "\n";
+
+    }
+
+    if (runs.empty()) {
+        std::cout << "No instance could be run.\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto runs_path = outpath + "bench.csv";
+    store_runs(runs_path, runs);
+    std::cout << "Results stored in " << runs_path << "\n";
+
+    if (!baseline_path.empty()) {
+        auto baseline = std::vector<Run>();
+        if (!load_runs(baseline_path, baseline)) {
+            std::cout << "Unable to read the baseline '" << baseline_path << "'.\n";
+            return EXIT_FAILURE;
+        }
+        compare(outpath + "comparison.csv", baseline, runs);
+    }
+
+    return EXIT_SUCCESS;
+
+}
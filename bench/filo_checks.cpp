@@ -0,0 +1,283 @@
+// Consistency checks on a set of X instances, run on request after changes which must not alter the results: each check
+// is run on every instance and prints OK or the first difference found. The exit status is non-zero if any check fails.
+//
+// Usage: filo_checks <instance> [<instance> ...]
+// Checks, run with short ROUTEMIN and COREOPT budgets and otherwise default parameters:
+// - loader: the instances built from the mapped X parser and from a binary copy match the one built by COBRA's parser;
+// - determinism: solving twice with the same seed, on the solver's move generators and on move generators of its own as
+//   batch workers do, gives the same routes and cost;
+// - solution_io: a solution stored and loaded back has the same routes and cost;
+// - checkpoint: a checkpoint stored and loaded back holds the same state;
+// - reoptimize: re-optimizing a solution of the unchanged instance serves every customer once, at no higher cost.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include "arg_parser.hpp"
+#include "Solver.hpp"
+#include "checkpoint.hpp"
+#include "instance_loader.hpp"
+#include "solution_io.hpp"
+
+namespace {
+
+    constexpr auto checks_routemin_iterations = "1000";
+    constexpr auto checks_coreopt_iterations = "2000";
+    constexpr auto checks_seed = 0;
+
+    // Instance, solver and a solution of checks_seed shared by the checks of an instance.
+    struct Context {
+        const std::string& instance_path;
+        const cobra::Instance& instance;
+        Solver& solver;
+        const cobra::Solution& solution;
+    };
+
+    struct Check {
+        const char* name;
+        std::function<bool(Context& context, std::string& error)> run;
+    };
+
+    std::string get_temporary_path(const std::string& name) {
+        return (std::filesystem::temp_directory_path() / ("filo_checks_" + std::to_string(getpid()) + "_" + name)).string();
+    }
+
+    // Routes of solution as lists of customers, sorted so that solutions are compared regardless of route indices.
+    std::vector<std::vector<int>> get_routes(const cobra::Instance& instance, const cobra::Solution& solution) {
+        auto routes = std::vector<std::vector<int>>();
+        for (auto route = solution.get_first_route(); route != cobra::Solution::dummy_route; route = solution.get_next_route(route)) {
+            auto& customers = routes.emplace_back();
+            for (auto curr = solution.get_first_customer(route); curr != instance.get_depot(); curr = solution.get_next_vertex(curr)) {
+                customers.push_back(curr);
+            }
+        }
+        std::sort(routes.begin(), routes.end());
+        return routes;
+    }
+
+    bool same_solution(const cobra::Instance& instance, const cobra::Solution& a, const cobra::Solution& b, std::string& error) {
+        if (get_routes(instance, a) != get_routes(instance, b)) {
+            error = "different routes";
+            return false;
+        }
+        if (a.get_cost() != b.get_cost()) {
+            error = "different costs " + std::to_string(a.get_cost()) + " and " + std::to_string(b.get_cost());
+            return false;
+        }
+        return true;
+    }
+
+    bool check_loader(Context& context, std::string& error) {
+
+        const auto& reference = context.instance;
+
+        const auto mapped = cobra::Instance::make<instance_loader::MappedXInstanceParser, true>(context.instance_path);
+        if (!mapped) {
+            error = "the mapped parser cannot parse the instance";
+            return false;
+        }
+        if (!instance_loader::matches(reference, *mapped, error)) {
+            error = "mapped parser: " + error;
+            return false;
+        }
+
+        const auto binary_path = get_temporary_path("instance.bin");
+        if (!instance_loader::store_binary(binary_path, reference, true)) {
+            error = "cannot store the binary instance";
+            return false;
+        }
+        const auto binary = cobra::Instance::make<instance_loader::BinaryInstanceParser, true>(binary_path);
+        auto remove_error = std::error_code();
+        std::filesystem::remove(binary_path, remove_error);
+        if (!binary) {
+            error = "the binary parser cannot parse the stored instance";
+            return false;
+        }
+        if (!instance_loader::matches(reference, *binary, error)) {
+            error = "binary parser: " + error;
+            return false;
+        }
+
+        return true;
+
+    }
+
+    bool check_determinism(Context& context, std::string& error) {
+
+        const auto again = context.solver.solve(checks_seed, std::chrono::high_resolution_clock::now());
+        if (!same_solution(context.instance, context.solution, again, error)) {
+            error = "second run: " + error;
+            return false;
+        }
+
+        auto worker_move_generators = cobra::MoveGenerators(context.instance, context.solver.get_views());
+        const auto batch = context.solver.solve(checks_seed, worker_move_generators, std::chrono::high_resolution_clock::now());
+        if (!same_solution(context.instance, context.solution, batch, error)) {
+            error = "run on separate move generators: " + error;
+            return false;
+        }
+
+        return true;
+
+    }
+
+    bool check_solution_io(Context& context, std::string& error) {
+
+        const auto path = get_temporary_path("solution.vrp.sol");
+        if (!solution_io::store(context.instance, context.solution, path)) {
+            error = "cannot store the solution";
+            return false;
+        }
+
+        auto loaded = cobra::Solution(context.instance, std::min(context.instance.get_vertices_num(), context.solver.get_parameters().get_solution_cache_size()));
+        const auto loaded_ok = solution_io::load(context.instance, path, loaded, error);
+        auto remove_error = std::error_code();
+        std::filesystem::remove(path, remove_error);
+
+        return loaded_ok && same_solution(context.instance, context.solution, loaded, error);
+
+    }
+
+    bool check_checkpoint(Context& context, std::string& error) {
+
+        const auto& instance = context.instance;
+        const auto vertices_num = instance.get_vertices_num();
+
+        // arbitrary state, with a random engine which is not in its initial state
+        auto rand_engine = std::mt19937(checks_seed);
+        rand_engine.discard(1000);
+        auto gamma = std::vector<float>(vertices_num);
+        auto gamma_counter = std::vector<int>(vertices_num);
+        auto omega = std::vector<int>(vertices_num);
+        auto values_distribution = std::uniform_real_distribution<float>(0.0f, 1.0f);
+        for (auto i = 0; i < vertices_num; i++) {
+            gamma[i] = values_distribution(rand_engine);
+            gamma_counter[i] = static_cast<int>(rand_engine() % 100);
+            omega[i] = static_cast<int>(rand_engine() % 10);
+        }
+
+        const auto path = get_temporary_path("solution.checkpoint");
+        if (!checkpoint::store(path, instance, 123, 45, 67, 8.5f, rand_engine, gamma, gamma_counter, omega, context.solution, context.solution)) {
+            error = "cannot store the checkpoint";
+            return false;
+        }
+
+        const auto state = checkpoint::load(path, instance, std::min(vertices_num, context.solver.get_parameters().get_solution_cache_size()), error);
+        auto remove_error = std::error_code();
+        std::filesystem::remove(path, remove_error);
+        if (!state) { return false; }
+
+        if (state->iteration != 123 || state->elapsed_seconds != 45 || state->annealing_seconds != 67 || state->mean_vertices_accessed != 8.5f) {
+            error = "different counters";
+            return false;
+        }
+        if (state->rand_engine != rand_engine) {
+            error = "different random engine state";
+            return false;
+        }
+        if (state->gamma != gamma || state->gamma_counter != gamma_counter || state->omega != omega) {
+            error = "different gamma, gamma counters or omega";
+            return false;
+        }
+
+        return same_solution(instance, context.solution, *state->solution, error) && same_solution(instance, context.solution, *state->best_solution, error);
+
+    }
+
+    bool check_reoptimize(Context& context, std::string& error) {
+
+        const auto& instance = context.instance;
+
+        auto delta = Solver::Delta();
+        delta.routes = get_routes(instance, context.solution);
+
+        const auto reoptimized = context.solver.reoptimize(delta, checks_seed, std::stoi(checks_coreopt_iterations), error);
+        if (!reoptimized) { return false; }
+
+        auto served = std::vector<int>(instance.get_vertices_num(), 0);
+        for (const auto& route : get_routes(instance, *reoptimized)) {
+            for (auto customer : route) { served[customer]++; }
+        }
+        for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+            if (served[i] != 1) {
+                error = "customer " + std::to_string(i) + " served " + std::to_string(served[i]) + " times";
+                return false;
+            }
+        }
+
+        if (reoptimized->get_cost() > context.solution.get_cost()) {
+            error = "cost increased from " + std::to_string(context.solution.get_cost()) + " to " + std::to_string(reoptimized->get_cost());
+            return false;
+        }
+
+        return true;
+
+    }
+
+    const Check checks[] = {
+        {"loader", check_loader},
+        {"determinism", check_determinism},
+        {"solution_io", check_solution_io},
+        {"checkpoint", check_checkpoint},
+        {"reoptimize", check_reoptimize},
+    };
+
+}
+
+auto main(int argc, char* argv[]) -> int {
+
+    if (argc < 2) {
+        std::cout << "Usage: filo_checks <instance> [<instance> ...]\n";
+        return EXIT_FAILURE;
+    }
+
+    auto failures = 0;
+
+    for (auto n = 1; n < argc; n++) {
+
+        const auto instance_path = std::string(argv[n]);
+
+        const auto maybe_instance = cobra::Instance::make<cobra::XInstanceParser, true>(instance_path);
+        if (!maybe_instance) {
+            std::cout << instance_path << ": FAILED, COBRA cannot parse the instance\n";
+            failures++;
+            continue;
+        }
+        const auto& instance = maybe_instance.value();
+
+        auto parameters = Parameters(instance_path);
+        auto error = std::string();
+        if (!parameters.set(TOKEN_ROUTEMIN_ITERATIONS, checks_routemin_iterations, error) ||
+            !parameters.set(TOKEN_COREOPT_ITERATIONS, checks_coreopt_iterations, error)) {
+            std::cout << "Error: " << error << ".\n";
+            return EXIT_FAILURE;
+        }
+
+        auto solver = Solver(instance, parameters, true);
+        const auto solution = solver.solve(checks_seed, std::chrono::high_resolution_clock::now());
+
+        auto context = Context{instance_path, instance, solver, solution};
+
+        for (const auto& check : checks) {
+            error.clear();
+            const auto passed = check.run(context, error);
+            std::cout << instance_path << " " << check.name << ": " << (passed ? "OK" : "FAILED, " + error) << "\n";
+            if (!passed) { failures++; }
+        }
+
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
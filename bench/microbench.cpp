@@ -0,0 +1,244 @@
+// Microbenchmarks of the components whose cost grows with the instance size, on synthetic uniform instances: the exact
+// mean arc cost pass, bpp::greedy_first_fit_decreasing, the copy of a solution, RuinAndRecreate::apply and the
+// reinsertion loop of ROUTEMIN. Each component is timed in isolation (setup work such as restoring the solution is not
+// measured) and reported in ns/op, along with the scaling exponent with respect to the previous size, i.e. the b of
+// ns/op ~ n^b, which tells which component becomes the bottleneck as n grows.
+//
+// Usage: filo_microbench [--sizes N1,N2,...] [--min-seconds S] [--outpath DIR]
+// Only header-only parts of filo are used, so the target does not depend on the GUI or VERBOSE build options.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include "arg_parser.hpp"
+#include "bpp.hpp"
+#include "mean_arc_cost.hpp"
+#include "CostTable.hpp"
+#include "RuinAndRecreate.hpp"
+#include "routemin.hpp"
+
+namespace {
+
+    struct Result {
+        std::string component;
+        int customers = 0;
+        long ops = 0;
+        double ns_per_op = 0.0;
+    };
+
+    // Writes an X format instance with customers uniformly spread over a square, demands in [1, 100] and a capacity
+    // of approx. 20 customers per route.
+    std::string write_synthetic_instance(const std::string& outpath, int customers) {
+
+        const auto path = outpath + "synthetic-n" + std::to_string(customers + 1) + ".vrp";
+
+        auto rand_engine = std::mt19937(customers);
+        auto coordinates_dist = std::uniform_int_distribution<int>(0, 10000);
+        auto demand_dist = std::uniform_int_distribution<int>(1, 100);
+
+        auto stream = std::ofstream(path);
+        stream << "NAME : synthetic-n" << customers + 1 << "\n";
+        stream << "TYPE : CVRP\n";
+        stream << "DIMENSION : " << customers + 1 << "\n";
+        stream << "EDGE_WEIGHT_TYPE : EUC_2D\n";
+        stream << "CAPACITY : 1000\n";
+        stream << "NODE_COORD_SECTION\n";
+        stream << "1 5000 5000\n";
+        for (auto i = 2; i <= customers + 1; i++) {
+            stream << i << " " << coordinates_dist(rand_engine) << " " << coordinates_dist(rand_engine) << "\n";
+        }
+        stream << "DEMAND_SECTION\n";
+        stream << "1 0\n";
+        for (auto i = 2; i <= customers + 1; i++) {
+            stream << i << " " << demand_dist(rand_engine) << "\n";
+        }
+        stream << "DEPOT_SECTION\n";
+        stream << "1\n";
+        stream << "-1\n";
+        stream << "EOF\n";
+
+        return path;
+
+    }
+
+    // Repeats operation, which returns the ns spent by the measured part of one op, until min_seconds have been
+    // measured (at least once).
+    template <typename Operation>
+    Result measure(const std::string& component, int customers, double min_seconds, Operation operation) {
+
+        auto result = Result();
+        result.component = component;
+        result.customers = customers;
+
+        auto total_ns = 0.0;
+        do {
+            total_ns += operation();
+            result.ops++;
+        } while (total_ns < min_seconds * 1e9);
+
+        result.ns_per_op = total_ns / static_cast<double>(result.ops);
+
+        std::cout << std::left << std::setw(22) << component << std::right << std::setw(10) << customers << std::setw(12) << result.ops
+                  << std::setw(18) << std::fixed << std::setprecision(1) << result.ns_per_op << std::defaultfloat << "\n";
+
+        return result;
+
+    }
+
+    template <typename Function>
+    double time_ns(Function function) {
+        const auto begin = std::chrono::high_resolution_clock::now();
+        function();
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(end - begin).count();
+    }
+
+    // keeps the compiler from discarding results which are otherwise unused
+    volatile double sink = 0.0;
+
+}
+
+auto main(int argc, char* argv[]) -> int {
+
+    auto sizes = std::vector<int>{1000, 3000, 10000, 30000, 100000};
+    auto min_seconds = 0.5;
+    auto outpath = std::string("bench-results/");
+
+    for (auto n = 1; n < argc; n += 2) {
+
+        const auto token = std::string(argv[n]);
+        if (token == TOKEN_HELP) {
+            std::cout << "Usage: filo_microbench [--sizes N1,N2,...] [--min-seconds S] [--outpath DIR]\n";
+            return EXIT_SUCCESS;
+        }
+        if (n + 1 >= argc) {
+            std::cout << "Missing value for '" << token << "'.\n";
+            return EXIT_FAILURE;
+        }
+        const auto value = std::string(argv[n + 1]);
+
+        if (token == "--sizes") {
+            sizes.clear();
+            auto stream = std::istringstream(value);
+            for (auto size = std::string(); std::getline(stream, size, ',');) {
+                sizes.emplace_back(std::stoi(size));
+            }
+        } else if (token == "--min-seconds") {
+            min_seconds = std::stod(value);
+        } else if (token == TOKEN_OUTPATH) {
+            outpath = value.back() == '/' ? value : value + '/';
+        } else {
+            std::cout << "Error: unknown argument '" << token << "'.\n";
+            return EXIT_FAILURE;
+        }
+
+    }
+
+    std::filesystem::create_directories(outpath);
+
+    std::cout << std::left << std::setw(22) << "Component" << std::right << std::setw(10) << "Customers" << std::setw(12) << "Ops"
+              << std::setw(18) << "ns/op" << "\n";
+
+    auto results = std::vector<Result>();
+
+    for (const auto customers : sizes) {
+
+        const auto instance_path = write_synthetic_instance(outpath, customers);
+        const auto maybe_instance = cobra::Instance::make<cobra::XInstanceParser, true>(instance_path);
+        std::filesystem::remove(instance_path);
+        if (!maybe_instance) {
+            std::cout << "Unable to parse the synthetic instance with " << customers << " customers.\n";
+            return EXIT_FAILURE;
+        }
+        const auto& instance = maybe_instance.value();
+
+        auto rand_engine = std::mt19937(0);
+
+        results.emplace_back(measure("mean_arc_cost", customers, min_seconds, [&]() {
+            return time_ns([&]() { sink = mean_arc_cost::compute(instance, 1); });
+        }));
+
+        results.emplace_back(measure("bpp_ffd", customers, min_seconds, [&]() {
+            return time_ns([&]() { sink = bpp::greedy_first_fit_decreasing(instance); });
+        }));
+
+        auto base = cobra::Solution(instance, std::min(instance.get_vertices_num(), DEFAULT_SOLUTION_CACHE_HISTORY));
+        cobra::Solution::clarke_and_wright(instance, base, DEFAULT_CW_LAMBDA, DEFAULT_CW_NEIGHBORS);
+        base.clear_cache();
+
+        auto solution = base;
+
+        results.emplace_back(measure("solution_copy", customers, min_seconds, [&]() {
+            return time_ns([&]() { solution = base; });
+        }));
+
+        const auto costs = CostTable(instance, true, DEFAULT_COST_MATRIX_MAX_VERTICES,
+                                     std::max(DEFAULT_SPARSIFICATION_RULE1_NEIGHBORS, DEFAULT_RECREATE_NEIGHBORS) + 1);
+
+        // shaking intensity used by COREOPT at the beginning of the search
+        const auto omega_base = std::max(1, static_cast<int>(std::ceil(std::log(instance.get_vertices_num()))));
+        const auto omega = std::vector<int>(instance.get_vertices_num(), omega_base);
+        auto rr = RuinAndRecreate(instance, costs, rand_engine, DEFAULT_RECREATE_NEIGHBORS, DEFAULT_FLAT_ROUTES);
+
+        results.emplace_back(measure("ruin_and_recreate", customers, min_seconds, [&]() {
+            solution = base;
+            return time_ns([&]() { sink = rr.apply(solution, omega); });
+        }));
+
+        auto knn_view = cobra::KNeighborsMoveGeneratorsView(instance, DEFAULT_SPARSIFICATION_RULE1_NEIGHBORS);
+        auto views = std::vector<cobra::AbstractMoveGeneratorsView*>{&knn_view};
+        auto move_generators = cobra::MoveGenerators(instance, views);
+        auto worker = RouteminWorker(instance, costs, move_generators, rand_engine, DEFAULT_TOLERANCE, DEFAULT_FLAT_ROUTES, false);
+        auto customers_dist = std::uniform_int_distribution<int>(instance.get_customers_begin(), instance.get_customers_end() - 1);
+        auto still_removed = std::vector<int>();
+
+        // customers which do not fit any route always open a new one, as in ROUTEMIN at its lowest temperature
+        results.emplace_back(measure("routemin_reinsertion", customers, min_seconds, [&]() {
+            solution = base;
+            still_removed.clear();
+            worker.remove_routes(solution, still_removed, customers_dist(rand_engine));
+            const auto ns = time_ns([&]() { worker.reinsert(solution, still_removed, 0.0f, 0); });
+            solution.clear_cache();
+            return ns;
+        }));
+
+    }
+
+    // scaling exponent of each component between consecutive sizes
+    const auto results_path = outpath + "microbench.csv";
+    auto stream = std::ofstream(results_path);
+    stream << "component,customers,ops,ns_per_op,ns_per_op_per_customer,scaling_exponent\n";
+
+    for (auto n = 0u; n < results.size(); n++) {
+
+        const auto& result = results[n];
+
+        const auto previous = std::find_if(results.rbegin() + static_cast<long>(results.size() - n), results.rend(), [&result](const Result& r) {
+            return r.component == result.component;
+        });
+        const auto exponent = previous != results.rend() && previous->customers != result.customers ?
+                              std::log(result.ns_per_op / previous->ns_per_op) / std::log(static_cast<double>(result.customers) / previous->customers) :
+                              std::nan("");
+
+        stream << result.component << "," << result.customers << "," << result.ops << "," << result.ns_per_op << ","
+               << result.ns_per_op / result.customers << "," << exponent << "\n";
+
+    }
+
+    std::cout << "Results stored in " << results_path << "\n";
+
+    return EXIT_SUCCESS;
+
+}
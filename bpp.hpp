@@ -7,11 +7,64 @@
 
 
 #include <algorithm>
+#include <vector>
 
 
 namespace bpp {
 
-    int greedy_first_fit_decreasing(const cobra::Instance &instance) {
+    namespace detail {
+
+        // Max segment tree over the residual capacities of the bins, used to find the leftmost bin that fits an item in
+        // O(log n). Unused bins have full residual capacity.
+        class ResidualTree {
+
+            int leaves_num = 1;
+            std::vector<int> tree;
+
+         public:
+
+            ResidualTree(int bins_num, int capacity) {
+                while (leaves_num < bins_num) {
+                    leaves_num *= 2;
+                }
+                tree.resize(2 * leaves_num, capacity);
+            }
+
+            // Returns the leftmost bin with residual capacity at least demand, or -1 if none.
+            int find_first_fit(int demand) const {
+                if (tree[1] < demand) { return -1; }
+                auto node = 1;
+                while (node < leaves_num) {
+                    node = tree[2 * node] >= demand ? 2 * node : 2 * node + 1;
+                }
+                return node - leaves_num;
+            }
+
+            void consume(int bin, int demand) {
+                auto node = bin + leaves_num;
+                tree[node] -= demand;
+                for (node /= 2; node > 0; node /= 2) {
+                    tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+                }
+            }
+
+        };
+
+        inline std::vector<int> get_sorted_demands(const cobra::Instance &instance) {
+            auto demands = std::vector<int>();
+            demands.reserve(instance.get_customers_num());
+            for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+                demands.emplace_back(instance.get_demand(i));
+            }
+            std::sort(demands.begin(), demands.end());
+            return demands;
+        }
+
+    }
+
+    // First fit decreasing upper bound on the n. of bins. When bin_of is given, it is filled with the bin index of each
+    // vertex (-1 for the depot).
+    inline int greedy_first_fit_decreasing(const cobra::Instance &instance, std::vector<int>* bin_of = nullptr) {
 
         auto customers = std::vector<int>();
         customers.reserve(instance.get_customers_num());
@@ -23,33 +76,92 @@ namespace bpp {
         std::sort(customers.begin(), customers.end(),
                   [&instance](auto i, auto j) { return instance.get_demand(i) > instance.get_demand(j); });
 
-        struct bin {
-            int load{};
-            std::vector<int> customers{};
-        };
+        if (bin_of) {
+            bin_of->assign(instance.get_vertices_num(), -1);
+        }
 
-        auto bins = std::vector<bin>(instance.get_customers_num());
+        auto residuals = detail::ResidualTree(instance.get_customers_num(), instance.get_vehicle_capacity());
 
-        auto used_bins = 0ul;
+        auto used_bins = 0;
         for(auto i : customers) {
             const auto i_demand = instance.get_demand(i);
-            for(auto p = 0ul; p < bins.size(); p++) {
-                auto& bin = bins[p];
-                if(bin.load + i_demand <= instance.get_vehicle_capacity()) {
-                    bin.load += i_demand;
-                    bin.customers.push_back(i);
-                    if(p+1 > used_bins) {
-                        used_bins = p + 1;
-                    }
-                    break;
-                }
+            const auto p = residuals.find_first_fit(i_demand);
+            if (p < 0) { continue; }
+            residuals.consume(p, i_demand);
+            if (bin_of) {
+                (*bin_of)[i] = p;
             }
+            used_bins = std::max(used_bins, p + 1);
         }
 
         return used_bins;
 
     }
 
+    // Continuous lower bound on the n. of bins, i.e. ceil(total demand / capacity).
+    inline int continuous_lower_bound(const cobra::Instance &instance) {
+
+        auto total_demand = 0l;
+        for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+            total_demand += instance.get_demand(i);
+        }
+
+        const auto capacity = static_cast<long>(instance.get_vehicle_capacity());
+
+        return static_cast<int>((total_demand + capacity - 1) / capacity);
+
+    }
+
+    // Martello and Toth L2 lower bound on the n. of bins. For every threshold alpha in [0, Q/2], items larger than Q/2
+    // need one bin each, and items in [alpha, Q/2] need at least the bins required by the demand exceeding the
+    // residual capacity of the bins of items in (Q/2, Q - alpha]. Only the alpha values matching an item demand need
+    // to be evaluated, each one in O(log n) using prefix sums of the sorted demands.
+    inline int l2_lower_bound(const cobra::Instance &instance) {
+
+        const auto demands = detail::get_sorted_demands(instance);
+        const auto capacity = static_cast<long>(instance.get_vehicle_capacity());
+
+        auto prefix_sums = std::vector<long>(demands.size() + 1, 0);
+        for (auto n = 0ul; n < demands.size(); n++) {
+            prefix_sums[n + 1] = prefix_sums[n] + demands[n];
+        }
+
+        // first index with demand > value and demand >= value
+        const auto upper = [&demands](long value) { return static_cast<long>(std::upper_bound(demands.begin(), demands.end(), value) - demands.begin()); };
+        const auto lower = [&demands](long value) { return static_cast<long>(std::lower_bound(demands.begin(), demands.end(), value) - demands.begin()); };
+
+        const auto items_num = static_cast<long>(demands.size());
+        const auto half_end = upper(capacity / 2);
+
+        auto bound = 0l;
+
+        const auto evaluate = [&](long alpha) {
+            const auto j2_begin = half_end;
+            const auto j2_end = upper(capacity - alpha);
+            const auto j3_begin = lower(alpha);
+            const auto j12_num = items_num - j2_begin;
+            const auto j2_num = j2_end - j2_begin;
+            const auto j2_residual = j2_num * capacity - (prefix_sums[j2_end] - prefix_sums[j2_begin]);
+            const auto j3_demand = prefix_sums[half_end] - prefix_sums[j3_begin];
+            const auto extra = std::max(0l, (j3_demand - j2_residual + capacity - 1) / capacity);
+            bound = std::max(bound, j12_num + extra);
+        };
+
+        evaluate(0);
+        for (auto n = 0l; n < half_end; n++) {
+            if (n > 0 && demands[n] == demands[n - 1]) { continue; }
+            evaluate(demands[n]);
+        }
+
+        return static_cast<int>(bound);
+
+    }
+
+    // Best available lower bound on the n. of bins.
+    inline int lower_bound(const cobra::Instance &instance) {
+        return std::max(continuous_lower_bound(instance), l2_lower_bound(instance));
+    }
+
 }
 
 
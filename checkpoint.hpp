@@ -0,0 +1,183 @@
+#ifndef FILO__CHECKPOINT_HPP_
+#define FILO__CHECKPOINT_HPP_
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include "solution_io.hpp"
+#include "atomic_file.hpp"
+
+// Checkpoints of the main COREOPT trajectory, i.e. everything needed to continue it in a later run: the current and
+// best solutions, the per-vertex gamma, gamma_counter and omega values, the random engine, the iteration (which also
+// determines the iteration-based annealing temperature), the elapsed runtime and the duration of the time-based annealing
+// schedule. Checkpoints are text files made of
+// "key values" lines, with solutions stored as "Route #k: ..." lines as in the .vrp.sol format.
+namespace checkpoint {
+
+    constexpr auto header = "FILO-CHECKPOINT";
+    constexpr auto version = 2;
+
+    struct State {
+        int iteration = 0;
+        long elapsed_seconds = 0;
+        // seconds over which the time-based annealing cools down, fixed when COREOPT first started
+        long annealing_seconds = 0;
+        float mean_vertices_accessed = 0.0f;
+        std::mt19937 rand_engine;
+        std::vector<float> gamma;
+        std::vector<int> gamma_counter;
+        std::vector<int> omega;
+        std::optional<cobra::Solution> solution;
+        std::optional<cobra::Solution> best_solution;
+    };
+
+    // Where and how often the main COREOPT trajectory stores its progress, and the state it resumes from, if any.
+    struct Settings {
+        std::string checkpoint_path;
+        std::string solution_path;
+        int period = 0;
+        const State* resume = nullptr;
+    };
+
+    namespace detail {
+
+        template <typename T>
+        void write_values(std::ostream& stream, const std::string& key, const std::vector<T>& values) {
+            stream << key << " " << values.size();
+            for (auto value : values) {
+                stream << " " << value;
+            }
+            stream << "\n";
+        }
+
+        template <typename T>
+        bool read_values(std::istream& stream, const std::string& key, std::vector<T>& values, size_t size) {
+            auto read_key = std::string();
+            auto read_size = size_t{0};
+            if (!(stream >> read_key >> read_size) || read_key != key || read_size != size) { return false; }
+            values.resize(size);
+            for (auto& value : values) {
+                if (!(stream >> value)) { return false; }
+            }
+            return true;
+        }
+
+        inline void write_solution(std::ostream& stream, const std::string& key, const cobra::Instance& instance, const cobra::Solution& solution) {
+            stream << key << " " << solution.get_routes_num() << "\n";
+            solution_io::write_routes(stream, instance, solution);
+        }
+
+        inline bool read_solution(std::istream& stream, const std::string& key, const cobra::Instance& instance, cobra::Solution& solution,
+                                  std::string& error) {
+
+            auto read_key = std::string();
+            auto routes_num = 0;
+            if (!(stream >> read_key >> routes_num) || read_key != key || routes_num < 0) {
+                error = "missing " + key;
+                return false;
+            }
+            stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+            auto routes = std::vector<std::vector<int>>(routes_num);
+            for (auto& customers : routes) {
+                auto line = std::string();
+                if (!std::getline(stream, line) || !solution_io::parse_route(line, customers)) {
+                    error = "malformed " + key;
+                    return false;
+                }
+            }
+
+            if (!solution_io::build(instance, routes, solution, error)) {
+                error = key + ": " + error;
+                return false;
+            }
+
+            return true;
+
+        }
+
+    }
+
+    // Writes to a temporary file which is then renamed, so that an interrupted run always leaves a complete checkpoint.
+    inline bool store(const std::string& path, const cobra::Instance& instance, int iteration, long elapsed_seconds, long annealing_seconds,
+                      float mean_vertices_accessed,
+                      const std::mt19937& rand_engine, const std::vector<float>& gamma, const std::vector<int>& gamma_counter,
+                      const std::vector<int>& omega, const cobra::Solution& solution, const cobra::Solution& best_solution) {
+
+        return atomic_file::write(path, std::ios::out, [&](std::ofstream& stream) {
+            stream.precision(std::numeric_limits<float>::max_digits10);
+
+            stream << header << " " << version << "\n";
+            stream << "iteration " << iteration << "\n";
+            stream << "elapsed-seconds " << elapsed_seconds << "\n";
+            stream << "annealing-seconds " << annealing_seconds << "\n";
+            stream << "mean-vertices-accessed " << mean_vertices_accessed << "\n";
+            stream << "rand-engine " << rand_engine << "\n";
+            detail::write_values(stream, "gamma", gamma);
+            detail::write_values(stream, "gamma-counter", gamma_counter);
+            detail::write_values(stream, "omega", omega);
+            detail::write_solution(stream, "solution", instance, solution);
+            detail::write_solution(stream, "best-solution", instance, best_solution);
+        });
+
+    }
+
+    // Loads the checkpoint stored in path. Returns std::nullopt, describing the reason in error, if the file cannot be
+    // read or does not belong to instance.
+    inline std::optional<State> load(const std::string& path, const cobra::Instance& instance, int solution_cache_size, std::string& error) {
+
+        auto stream = std::ifstream(path);
+        if (!stream) {
+            error = "unable to open the file";
+            return std::nullopt;
+        }
+
+        auto state = State();
+        auto key = std::string();
+        auto read_version = 0;
+
+        if (!(stream >> key >> read_version) || key != header || read_version != version) {
+            error = "not a version " + std::to_string(version) + " checkpoint";
+            return std::nullopt;
+        }
+
+        if (!(stream >> key >> state.iteration) || key != "iteration" ||
+            !(stream >> key >> state.elapsed_seconds) || key != "elapsed-seconds" ||
+            !(stream >> key >> state.annealing_seconds) || key != "annealing-seconds" ||
+            !(stream >> key >> state.mean_vertices_accessed) || key != "mean-vertices-accessed" ||
+            !(stream >> key >> state.rand_engine) || key != "rand-engine") {
+            error = "malformed header";
+            return std::nullopt;
+        }
+
+        const auto vertices_num = static_cast<size_t>(instance.get_vertices_num());
+        if (!detail::read_values(stream, "gamma", state.gamma, vertices_num) ||
+            !detail::read_values(stream, "gamma-counter", state.gamma_counter, vertices_num) ||
+            !detail::read_values(stream, "omega", state.omega, vertices_num)) {
+            error = "malformed or mismatching per-vertex values";
+            return std::nullopt;
+        }
+
+        const auto cache_size = std::min(instance.get_vertices_num(), solution_cache_size);
+
+        state.solution.emplace(instance, cache_size);
+        state.best_solution.emplace(instance, cache_size);
+        if (!detail::read_solution(stream, "solution", instance, *state.solution, error) ||
+            !detail::read_solution(stream, "best-solution", instance, *state.best_solution, error)) {
+            return std::nullopt;
+        }
+
+        return state;
+
+    }
+
+}
+
+#endif //FILO__CHECKPOINT_HPP_
@@ -0,0 +1,639 @@
+#ifndef FILO__COREOPT_HPP_
+#define FILO__COREOPT_HPP_
+
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <optional>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include <cobra/MoveGenerators.hpp>
+#include <cobra/LocalSearch.hpp>
+#include <cobra/SimulatedAnnealing.hpp>
+#include <cobra/PrettyPrinter.hpp>
+#include <cobra/Welford.hpp>
+#include "CostTable.hpp"
+#include "RuinAndRecreate.hpp"
+#include "RouteRestorer.hpp"
+#include "Decomposition.hpp"
+#include "checkpoint.hpp"
+#include "Profile.hpp"
+#include "MeasuredNeighborhoodDescent.hpp"
+#include "solution_io.hpp"
+#include "allocation_counter.hpp"
+#include "arg_parser.hpp"
+
+#ifdef GUI
+#include "Renderer.hpp"
+#endif
+
+// Best solution shared among concurrent COREOPT trajectories.
+class SharedBestSolution {
+
+    std::mutex mutex;
+    cobra::Solution solution;
+
+ public:
+
+    explicit SharedBestSolution(const cobra::Solution& solution_) : solution(solution_) { }
+
+    // Stores candidate if it improves the shared best solution.
+    void offer(const cobra::Solution& candidate) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (candidate.get_cost() < solution.get_cost()) {
+            solution = candidate;
+        }
+    }
+
+    // Copies the shared best solution into target if it improves it. Returns whether target has been updated.
+    bool fetch_if_better(cobra::Solution& target) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (solution.get_cost() < target.get_cost()) {
+            target = solution;
+            return true;
+        }
+        return false;
+    }
+
+    cobra::Solution get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return solution;
+    }
+
+};
+
+// Core optimization procedure starting from source. When shared_best is not null, the best solution found so far is
+// exchanged with the other trajectories every migration_period iterations. When decomposition is not null, the current
+// solution is re-optimized cluster by cluster every decomposition_period iterations. When checkpointing is not null, the
+// best solution and a checkpoint are stored every checkpointing->period seconds, and the procedure continues the
+// checkpoint in checkpointing->resume (if any), whose current solution must be source. When focus_vertices is not null,
+// the search is warm-started around them: their granular neighborhoods start fully active. When on_best_solution is not
+// null, it is invoked with every new best solution. When profile is not null, the time spent by each part of an
+// iteration and the hot path counters are added to it. Only the main trajectory reports its progress (VERBOSE), draws
+// the solution (GUI) and is checkpointed.
+inline cobra::Solution coreopt(const cobra::Instance& instance, const CostTable& costs, const Parameters& parameters, const cobra::Solution& source,
+                               std::mt19937& rand_engine, cobra::MoveGenerators& move_generators, double mean_arc_cost, bool round_costs,
+                               std::chrono::high_resolution_clock::time_point global_time_begin,
+                               SharedBestSolution* shared_best, Decomposition* decomposition, const checkpoint::Settings* checkpointing,
+                               const std::vector<int>* focus_vertices, const std::function<void(const cobra::Solution&)>* on_best_solution,
+                               Profile* profile, [[maybe_unused]] bool main_trajectory) {
+
+    const auto tolerance = parameters.get_tolerance();
+
+    // operators are measured, at the price of two clock reads per operator invocation, only when their statistics are
+    // asked for (and only in the profiled trajectory) or when they are selected adaptively
+    const auto measure_operators = profile && parameters.get_operator_statistics();
+    const auto adaptive_operators = parameters.get_adaptive_operators();
+    auto measured_descents = std::vector<const MeasuredNeighborhoodDescent<>*>();
+    const auto make_descent = [&](const std::vector<cobra::Operator>& operators) -> std::unique_ptr<cobra::VariableNeighborhoodDescentInterface> {
+        if (measure_operators || adaptive_operators) {
+            auto descent = std::make_unique<MeasuredNeighborhoodDescent<>>(instance, move_generators, operators, rand_engine, tolerance, adaptive_operators);
+            if (measure_operators) { measured_descents.emplace_back(descent.get()); }
+            return descent;
+        }
+        return std::make_unique<cobra::RandomizedVariableNeighborhoodDescent<>>(instance, move_generators, operators, rand_engine, tolerance);
+    };
+
+    auto rvnd0 = make_descent({
+        cobra::E11,cobra::E10,cobra::TAILS,cobra::SPLIT,cobra::RE22B,
+        cobra::E22,cobra::RE20,cobra::RE21,cobra::RE22S,cobra::E21,
+        cobra::E20,cobra::TWOPT,cobra::RE30,cobra::E30,cobra::RE33B,
+        cobra::E33,cobra::RE31,cobra::RE32B,cobra::RE33S,cobra::E31,
+        cobra::E32,cobra::RE32S});
+    auto rvnd1 = make_descent({
+        cobra::EJCH,
+    });
+
+    auto local_search = cobra::HierarchicalVariableNeighborhoodDescent(tolerance);
+    local_search.append(rvnd0.get());
+    local_search.append(rvnd1.get());
+
+    auto solution = source;
+
+    // COREOPT stops after coreopt_iterations iterations or when the total algorithm runtime reaches time_limit seconds
+    // (if positive), whichever comes first
+    const auto coreopt_iterations = parameters.get_coreopt_iterations();
+    const auto time_limit = parameters.get_time_limit();
+    const auto migration_period = parameters.get_migration_period();
+    const auto decomposition_period = parameters.get_decomposition_period();
+
+    const auto resume = checkpointing ? checkpointing->resume : nullptr;
+
+    auto best_solution = resume ? *resume->best_solution : solution;
+    #ifdef VERBOSE
+    auto best_solution_time = std::chrono::high_resolution_clock::now();
+    #endif
+
+    const auto gamma_base = parameters.get_gamma_base();
+    auto gamma = std::vector<float>(instance.get_vertices_num(), gamma_base);
+    auto gamma_counter = std::vector<int>(instance.get_vertices_num(), 0);
+
+    const auto delta = parameters.get_delta();
+    auto average_number_of_vertices_accessed = cobra::Welford();
+
+    if (focus_vertices) {
+        for (auto i : *focus_vertices) {
+            gamma[i] = 1.0f;
+        }
+    }
+
+    // the Welford accumulator is restored as a single sample with the checkpointed mean
+    if (resume) {
+        gamma = resume->gamma;
+        gamma_counter = resume->gamma_counter;
+        if (resume->mean_vertices_accessed > 0.0f) { average_number_of_vertices_accessed.update(resume->mean_vertices_accessed); }
+    }
+
+    auto gamma_vertices = std::vector<int>();
+    for(auto i = instance.get_vertices_begin(); i < instance.get_vertices_end(); i++) {
+        gamma_vertices.emplace_back(i);
+    }
+    move_generators.set_active_percentage(gamma, gamma_vertices);
+
+    auto ruined_customers = std::vector<int>();
+
+    #ifdef VERBOSE
+    auto partial_time_begin = std::chrono::high_resolution_clock::now();
+    auto partial_time_end = std::chrono::high_resolution_clock::now();
+
+    if (main_trajectory) {
+        if (time_limit <= 0) {
+            std::cout << "Running COREOPT for " << coreopt_iterations << " iterations.\n";
+        } else if (coreopt_iterations == std::numeric_limits<int>::max()) {
+            std::cout << "Running COREOPT for " << time_limit << " seconds.\n";
+        } else {
+            std::cout << "Running COREOPT for " << coreopt_iterations << " iterations or " << time_limit << " seconds, whichever comes first.\n";
+        }
+    }
+
+    auto welford_rac_before_shaking = cobra::Welford();
+    auto welford_rac_after_shaking = cobra::Welford();
+    auto welford_local_optima = cobra::Welford();
+    auto welford_shaken_solutions = cobra::Welford();
+    auto printer = cobra::PrettyPrinter({
+        {"%", cobra::PrettyPrinter::Field::Type::INTEGER, 3, " "},
+        {"Iterations", cobra::PrettyPrinter::Field::Type::INTEGER, 10, " "},
+        {"Objective", cobra::PrettyPrinter::Field::Type::INTEGER, 10, " "},
+        {"Routes", cobra::PrettyPrinter::Field::Type::INTEGER, 6, " "},
+        {"Found after (s)", cobra::PrettyPrinter::Field::Type::INTEGER, 15, " "},
+        {"Iter/s",cobra::PrettyPrinter::Field::Type::REAL, 10, " "},
+        {"Eta (s)", cobra::PrettyPrinter::Field::Type::REAL, 10, " "},
+        {"Gamma", cobra::PrettyPrinter::Field::Type::REAL, 5, " "},
+        {"Omega", cobra::PrettyPrinter::Field::Type::REAL, 6, " "},
+        {"Temp", cobra::PrettyPrinter::Field::Type::REAL, 6, " "}
+    });
+
+    auto main_opt_loop_begin_time = std::chrono::high_resolution_clock::now();
+
+    auto elapsed_minutes = 0;
+    #endif
+
+    #ifdef GUI
+    auto renderer = std::unique_ptr<Renderer>();
+    if (main_trajectory) {
+        renderer = std::make_unique<Renderer>(instance, solution.get_cost());
+    }
+    #endif
+
+    auto rr = RuinAndRecreate(instance, costs, rand_engine, parameters.get_recreate_neighbors(), parameters.get_flat_routes());
+
+    const auto intensification_lb = parameters.get_shaking_lb_factor();
+    const auto intensification_ub = parameters.get_shaking_ub_factor();
+
+    const auto mean_solution_arc_cost = solution.get_cost() / (static_cast<float>(instance.get_customers_num()) + 2.0f *static_cast<float>(solution.get_routes_num()));
+
+    auto shaking_lb_factor = mean_solution_arc_cost * intensification_lb;
+    auto shaking_ub_factor = mean_solution_arc_cost * intensification_ub;
+
+    #ifdef VERBOSE
+    if (main_trajectory) {
+        std::cout << "Shaking LB = " << shaking_lb_factor << "\n";
+        std::cout << "Shaking UB = " << shaking_ub_factor << "\n";
+    }
+    #endif
+
+    const auto omega_base = std::max(1, static_cast<int>(std::ceil(std::log(instance.get_vertices_num()))));
+    auto omega = resume ? resume->omega : std::vector<int>(instance.get_vertices_num(), omega_base);
+    auto random_choice = std::uniform_int_distribution(0, 1);
+
+    // a warm start from a given solution or around focus vertices begins at a lower temperature, so that its structure is not lost to early
+    // worsening moves, but ends at the usual final temperature
+    const auto sa_final_temperature = mean_arc_cost / 1000.0f;
+    auto sa_initial_temperature = mean_arc_cost / 10.0f;
+    if (!parameters.get_initial_solution().empty() || focus_vertices) {
+        sa_initial_temperature = std::max(sa_final_temperature, sa_initial_temperature * parameters.get_warm_start_temperature_factor());
+    }
+
+    // Elapsed seconds since global_time_begin. The clock is read every clock_period iterations only, with the period
+    // adjusted so that reads happen roughly every clock_target_interval seconds.
+    constexpr auto clock_target_interval = 0.01;
+    constexpr auto max_clock_period = 1024;
+    auto elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - global_time_begin).count();
+    auto clock_period = 1;
+    auto next_clock_iter = 0;
+    auto last_clock_read = std::chrono::high_resolution_clock::now();
+
+    // the temperature follows the runtime when only a time limit is given and the iterations when only an iteration limit
+    // is given. When both are given, both schedules are kept and the colder one is used, i.e. the one of the limit closer
+    // to be reached, so that the final temperature is reached whichever limit stops the run. A resumed run keeps the
+    // cooling window of the interrupted one, since the elapsed time passed to the annealing includes the checkpointed
+    // runtime
+    const auto time_based_annealing = time_limit > 0;
+    const auto iteration_based_annealing = coreopt_iterations < std::numeric_limits<int>::max();
+    const auto annealing_seconds = resume && resume->annealing_seconds > 0 ? resume->annealing_seconds : static_cast<long>(time_limit - elapsed_time);
+    auto sa = std::optional<cobra::SimulatedAnnealing>();
+    auto time_based_sa = std::optional<cobra::TimeBasedSimulatedAnnealing>();
+    if (time_based_annealing) {
+        time_based_sa.emplace(sa_initial_temperature, sa_final_temperature, rand_engine, annealing_seconds);
+    }
+    if (iteration_based_annealing || !time_based_annealing) {
+        sa.emplace(sa_initial_temperature, sa_final_temperature, rand_engine, coreopt_iterations);
+    }
+    const auto is_time_based_colder = [&sa, &time_based_sa](long elapsed_seconds) {
+        return !sa || (time_based_sa && time_based_sa->get_temperature(elapsed_seconds) < sa->get_temperature());
+    };
+
+    const auto first_iter = resume ? resume->iteration : 0;
+    if (resume) {
+        // the iteration-based temperature is replayed
+        if (sa) {
+            for (auto iter = 0; iter < first_iter; iter++) { sa->decrease_temperature(); }
+        }
+        rand_engine = resume->rand_engine;
+        #ifdef VERBOSE
+        std::cout << "Resuming COREOPT from iteration " << first_iter << " after " << resume->elapsed_seconds << " seconds.\n";
+        #endif
+    }
+
+    const auto checkpoint_period = checkpointing ? checkpointing->period : 0;
+    auto next_checkpoint_time = elapsed_time + checkpoint_period;
+    auto stored_best_solution_cost = std::numeric_limits<float>::max();
+
+
+    #ifdef VERBOSE
+    if (main_trajectory) {
+        std::cout << "Simulated annealing temperature goes from "<< sa_initial_temperature << " to " << sa_final_temperature << ".\n\n";
+    }
+    #endif
+
+    solution.clear_cache();
+
+    // neighbor is kept across iterations so that its storage is reused, and it is only refreshed from solution when
+    // the two differ. After a move, the routes touched by it are copied from one solution to the other (the neighbor
+    // into the current solution when accepted, and the other way round when rejected) as long as the cache of neighbor
+    // has recorded all the touched vertices, see RouteRestorer. Otherwise solutions are copied whole: the current
+    // solution right away, the neighbor at the next iteration.
+    auto neighbor = solution;
+    auto neighbor_is_current = true;
+    auto route_restorer = RouteRestorer(instance, std::min(instance.get_vertices_num(), parameters.get_solution_cache_size()), round_costs);
+
+    #ifdef ALLOCATION_COUNTER
+    auto rr_allocations = 0ul;
+    const auto coreopt_allocations_begin = allocation_counter::get();
+    #endif
+
+    // clock reads for the profile, only taken on the iterations in which the amortized clock above is read
+    auto profiled_iteration = false;
+    const auto profile_now = [&profiled_iteration]() {
+        return profiled_iteration ? std::chrono::high_resolution_clock::now() : std::chrono::high_resolution_clock::time_point();
+    };
+    const auto profile_seconds = [](std::chrono::high_resolution_clock::time_point begin, std::chrono::high_resolution_clock::time_point end) {
+        return std::chrono::duration<double>(end - begin).count();
+    };
+
+    for (auto iter = first_iter; iter < coreopt_iterations && (time_limit <= 0 || elapsed_time < time_limit); iter++) {
+
+        profiled_iteration = profile && iter >= next_clock_iter;
+        const auto iteration_begin = profile_now();
+
+        if (shared_best && iter > 0 && iter % migration_period == 0) {
+            shared_best->offer(best_solution);
+            if (shared_best->fetch_if_better(best_solution)) {
+                if (on_best_solution) { (*on_best_solution)(best_solution); }
+                solution = best_solution;
+                solution.clear_cache();
+                neighbor_is_current = false;
+                const auto updated_mean_solution_arc_cost = solution.get_cost() / (static_cast<float>(instance.get_customers_num()) + 2.0f * static_cast<float>(solution.get_routes_num()));
+                shaking_lb_factor = updated_mean_solution_arc_cost * intensification_lb;
+                shaking_ub_factor = updated_mean_solution_arc_cost * intensification_ub;
+            }
+        }
+
+        if (decomposition && iter > 0 && iter % decomposition_period == 0 && decomposition->apply(solution, gamma, omega)) {
+            if(!round_costs) { solution.recompute_costs(); }
+            neighbor_is_current = false;
+            if (solution.get_cost() < best_solution.get_cost()) {
+                best_solution = solution;
+                if (on_best_solution) { (*on_best_solution)(best_solution); }
+                #ifdef VERBOSE
+                best_solution_time = std::chrono::high_resolution_clock::now();
+                #endif
+            }
+            const auto updated_mean_solution_arc_cost = solution.get_cost() / (static_cast<float>(instance.get_customers_num()) + 2.0f * static_cast<float>(solution.get_routes_num()));
+            shaking_lb_factor = updated_mean_solution_arc_cost * intensification_lb;
+            shaking_ub_factor = updated_mean_solution_arc_cost * intensification_ub;
+        }
+
+        if (!neighbor_is_current) {
+            neighbor = solution;
+        }
+        neighbor_is_current = false;
+
+        #ifdef VERBOSE
+        if (main_trajectory && std::chrono::duration_cast<std::chrono::minutes>(
+            std::chrono::high_resolution_clock::now() - global_time_begin).count() >= elapsed_minutes + 5) {
+            printer.notify("Optimizing for " + std::to_string(std::chrono::duration_cast<std::chrono::minutes>(std::chrono::high_resolution_clock::now() - global_time_begin).count()) + " minutes.");
+            elapsed_minutes += 5;
+        }
+        #endif
+
+        #ifdef ALLOCATION_COUNTER
+        const auto rr_allocations_begin = allocation_counter::get();
+        #endif
+
+        const auto shaking_begin = profile_now();
+
+        const auto walk_seed = rr.apply(neighbor, omega);
+
+        const auto shaking_end = profile_now();
+
+        #ifdef ALLOCATION_COUNTER
+        rr_allocations += allocation_counter::get() - rr_allocations_begin;
+        #endif
+
+        #ifdef GUI
+        const auto shaken_solution_cost = neighbor.get_cost();
+        #endif
+
+        ruined_customers.clear();
+        for (auto i = neighbor.get_cache().begin(); i!=cobra::LRUCache::Entry::dummy_vertex; i = neighbor.get_cache().get_next(i)) {
+            ruined_customers.emplace_back(i);
+        }
+
+        #ifdef VERBOSE
+        welford_rac_after_shaking.update(static_cast<float>(neighbor.get_cache().size()));
+        welford_shaken_solutions.update(neighbor.get_cost());
+        #endif
+
+        local_search.apply(neighbor);
+
+        const auto local_search_end = profile_now();
+
+        #ifdef GUI
+        const auto local_optimum_cost = neighbor.get_cost();
+        #endif
+
+        average_number_of_vertices_accessed.update(static_cast<float>(neighbor.get_cache().size()));
+
+        if (profile) {
+            profile->get_coreopt().cache_size_sum += static_cast<double>(neighbor.get_cache().size());
+            profile->get_coreopt().cache_size_max = std::max(profile->get_coreopt().cache_size_max, static_cast<int>(neighbor.get_cache().size()));
+        }
+
+        auto expected_total_iterations_num = static_cast<float>(coreopt_iterations);
+        if (time_limit > 0) {
+            const auto iter_per_second = static_cast<float>(iter+1) / (static_cast<float>(elapsed_time) + 0.01f);
+            const auto remaining_time = time_limit - elapsed_time;
+            const auto estimated_remaining_iter = iter_per_second * remaining_time;
+            expected_total_iterations_num = std::min(expected_total_iterations_num, iter+1 + estimated_remaining_iter);
+        }
+
+        const auto max_non_improving_iterations = static_cast<int>(std::ceil(delta * expected_total_iterations_num * static_cast<float>(average_number_of_vertices_accessed.get_mean()) / static_cast<float>(instance.get_vertices_num())));
+
+        #ifdef GUI
+        if(renderer && iter % 100 == 0) { renderer->draw(best_solution, neighbor.get_cache(),move_generators); }
+        #endif
+
+        #ifdef VERBOSE
+        welford_rac_before_shaking.update(static_cast<float>(neighbor.get_cache().size()));
+        welford_local_optima.update(neighbor.get_cost());
+        #endif
+
+        if (neighbor.get_cost() < best_solution.get_cost()) {
+
+            best_solution = neighbor;
+            if (on_best_solution) { (*on_best_solution)(best_solution); }
+            #ifdef VERBOSE
+            best_solution_time = std::chrono::high_resolution_clock::now();
+            #endif
+
+            gamma_vertices.clear();
+            for (auto i = neighbor.get_cache().begin(); i!=cobra::LRUCache::Entry::dummy_vertex; i = neighbor.get_cache().get_next(i)) {
+                gamma[i] = gamma_base;
+                gamma_counter[i] = 0;
+                gamma_vertices.emplace_back(i);
+            }
+            move_generators.set_active_percentage(gamma, gamma_vertices);
+
+            #ifdef VERBOSE
+            welford_local_optima.reset();
+            welford_local_optima.update(neighbor.get_cost());
+            welford_shaken_solutions.reset();
+            welford_shaken_solutions.update(neighbor.get_cost());
+            #endif
+
+        } else {
+
+            for (auto i = neighbor.get_cache().begin(); i!=cobra::LRUCache::Entry::dummy_vertex; i = neighbor.get_cache().get_next(i)) {
+                gamma_counter[i]++;
+                if (gamma_counter[i] >= max_non_improving_iterations) {
+                    gamma[i] = std::min(gamma[i] * 2.0f, 1.0f);
+                    gamma_counter[i] = 0;
+                    gamma_vertices.clear();
+                    gamma_vertices.emplace_back(i);
+                    move_generators.set_active_percentage(gamma, gamma_vertices);
+                }
+            }
+
+        }
+
+        const auto seed_shake_value = omega[walk_seed];
+
+        if (neighbor.get_cost() > shaking_ub_factor + solution.get_cost()) {
+            for (auto i : ruined_customers) {
+                if (omega[i] > seed_shake_value - 1) {
+                    omega[i]--;
+                }
+            }
+        } else if (neighbor.get_cost() >= solution.get_cost() && neighbor.get_cost() < solution.get_cost() + shaking_lb_factor) {
+            for (auto i : ruined_customers) {
+                if (omega[i] < seed_shake_value + 1) {
+                    omega[i]++;
+                }
+            }
+        }  else  {
+            for(auto i : ruined_customers) {
+                if(random_choice(rand_engine)) {
+                    if (omega[i] > seed_shake_value - 1) {
+                        omega[i]--;
+                    }
+                } else {
+                    if (omega[i] < seed_shake_value + 1) {
+                        omega[i]++;
+                    }
+                }
+            }
+        }
+
+
+        if ((time_limit > 0 || checkpoint_period > 0 || profile) && iter >= next_clock_iter) {
+            const auto now = std::chrono::high_resolution_clock::now();
+            elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(now - global_time_begin).count();
+            const auto interval = std::chrono::duration<double>(now - last_clock_read).count();
+            if (interval < clock_target_interval / 2.0) {
+                clock_period = std::min(clock_period * 2, max_clock_period);
+            } else if (interval > clock_target_interval * 2.0) {
+                clock_period = std::max(clock_period / 2, 1);
+            }
+            last_clock_read = now;
+            next_clock_iter = iter + clock_period;
+        }
+
+        const auto accepted = is_time_based_colder(elapsed_time) ? time_based_sa->accept(solution, neighbor, elapsed_time) : sa->accept(solution, neighbor);
+
+        const auto restore_routes = route_restorer.is_complete(neighbor.get_cache());
+
+        if (accepted) {
+            if(!round_costs) { neighbor.recompute_costs(); } // avoid too many rounding errors get summed during LS
+            if (restore_routes) {
+                route_restorer.restore(solution, neighbor, neighbor.get_cache());
+            } else {
+                solution = neighbor;
+                solution.clear_cache();
+            }
+            neighbor.clear_cache();
+            neighbor_is_current = true;
+            const auto updated_mean_solution_arc_cost = solution.get_cost() / (static_cast<float>(instance.get_customers_num()) + 2.0f * static_cast<float>(solution.get_routes_num()));
+            shaking_lb_factor = updated_mean_solution_arc_cost * intensification_lb;
+            shaking_ub_factor = updated_mean_solution_arc_cost * intensification_ub;
+        } else if (restore_routes) {
+            route_restorer.restore(neighbor, solution, neighbor.get_cache());
+            neighbor_is_current = true;
+        }
+
+        if (time_based_sa) { time_based_sa->decrease_temperature(); }
+        if (sa) { sa->decrease_temperature(); }
+
+        if (checkpoint_period > 0 && elapsed_time >= next_checkpoint_time) {
+            // the best solution is only rewritten when it has changed since the last checkpoint
+            if (best_solution.get_cost() < stored_best_solution_cost && solution_io::store(instance, best_solution, checkpointing->solution_path)) {
+                stored_best_solution_cost = best_solution.get_cost();
+            }
+            if (!checkpoint::store(checkpointing->checkpoint_path, instance, iter + 1, elapsed_time, annealing_seconds,
+                                   static_cast<float>(average_number_of_vertices_accessed.get_mean()), rand_engine, gamma, gamma_counter, omega,
+                                   solution, best_solution)) {
+                std::cout << "Warning: unable to store the checkpoint in '" << checkpointing->checkpoint_path << "'.\n";
+            }
+            next_checkpoint_time = elapsed_time + checkpoint_period;
+        }
+
+        if (profile) {
+            auto& breakdown = profile->get_coreopt();
+            breakdown.iterations++;
+            if (profiled_iteration) {
+                const auto iteration_end = std::chrono::high_resolution_clock::now();
+                // the sample stands for the iterations up to the next clock read
+                const auto weight = static_cast<double>(std::max(1, std::min(next_clock_iter, coreopt_iterations) - iter));
+                breakdown.sampled_iterations++;
+                breakdown.migration_and_decomposition_seconds += weight * profile_seconds(iteration_begin, shaking_begin);
+                breakdown.shaking_seconds += weight * profile_seconds(shaking_begin, shaking_end);
+                breakdown.local_search_seconds += weight * profile_seconds(shaking_end, local_search_end);
+                breakdown.bookkeeping_seconds += weight * profile_seconds(local_search_end, iteration_end);
+            }
+        }
+
+        #ifdef GUI
+        if (renderer) { renderer->add_trajectory_point(shaken_solution_cost, local_optimum_cost, solution.get_cost(), best_solution.get_cost()); }
+        #endif
+
+        #ifdef VERBOSE
+        partial_time_end = std::chrono::high_resolution_clock::now();
+        if (main_trajectory && std::chrono::duration_cast<std::chrono::seconds>(partial_time_end - partial_time_begin).count() > 1) {
+
+            const auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - main_opt_loop_begin_time).count();
+            const auto iter_per_second = static_cast<float>(iter + 1)/(static_cast<float>(elapsed_seconds) + 0.01f);
+            auto progress = 100.0f*(iter + 1.0f)/static_cast<float>(coreopt_iterations);
+            auto estimated_rem_time = static_cast<float>(coreopt_iterations - iter)/iter_per_second;
+            if (time_limit > 0) {
+                progress = std::max(progress, 100.0f*static_cast<float>(elapsed_time)/static_cast<float>(time_limit));
+                estimated_rem_time = std::min(estimated_rem_time, static_cast<float>(time_limit - elapsed_time));
+            }
+
+            auto gamma_mean = 0.0f;
+            for (auto i = instance.get_vertices_begin(); i < instance.get_vertices_end(); i++) { gamma_mean += gamma[i]; }
+            gamma_mean = (gamma_mean/static_cast<float>(instance.get_vertices_num()));
+
+
+            auto omega_mean = 0.0f;
+            for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+                omega_mean += omega[i];
+            }
+            omega_mean /= static_cast<float>(instance.get_customers_num());
+
+
+            printer.print(progress, iter + 1,
+                          best_solution.get_cost(),
+                          best_solution.get_routes_num(),
+                          std::chrono::duration_cast<std::chrono::seconds>(best_solution_time - global_time_begin).count(),
+                          iter_per_second,
+                          estimated_rem_time,
+                          gamma_mean,
+                          omega_mean,
+                          is_time_based_colder(elapsed_time) ? time_based_sa->get_temperature(elapsed_time) : sa->get_temperature()
+            );
+
+            partial_time_begin = std::chrono::high_resolution_clock::now();
+
+        }
+        #endif
+
+    }
+
+    if (shared_best) {
+        shared_best->offer(best_solution);
+    }
+
+    if (profile) {
+        profile->get_coreopt().insertion_positions_evaluated += rr.get_insertion_positions_evaluated();
+        if (decomposition) {
+            profile->get_coreopt().decomposition_steps += decomposition->get_steps();
+            profile->get_coreopt().decomposition_seconds += decomposition->get_seconds();
+            profile->get_coreopt().decomposition_cluster_iterations += decomposition->get_cluster_iterations();
+        }
+        for (auto descent : measured_descents) {
+            profile->add_operators(descent->get_statistics());
+        }
+    }
+
+    #ifdef ALLOCATION_COUNTER
+    if (main_trajectory) {
+        std::cout << "Heap allocations during COREOPT: " << allocation_counter::get() - coreopt_allocations_begin << ", of which " << rr_allocations << " by ruin and recreate.\n";
+    }
+    #endif
+
+    #ifdef VERBOSE
+    if (main_trajectory) {
+        std::cout << "\n";
+        std::cout << "Best solution found:\n";
+        std::cout << "obj = " << best_solution.get_cost() << ", n. routes = " << best_solution.get_routes_num() << ", found after = " << std::chrono::duration_cast<std::chrono::seconds>(best_solution_time - global_time_begin).count() << " seconds ";
+        std::cout << "(" << std::chrono::duration_cast<std::chrono::milliseconds>(best_solution_time - global_time_begin).count() << " milliseconds).\n";
+    }
+
+    if (main_trajectory && profile && !profile->get_operators().empty()) {
+        std::cout << "\n";
+        std::cout << "Local search operators:\n";
+        for (const auto& op : profile->get_operators()) {
+            std::cout << " - " << op.name << ": " << op.invocations << " invocations, " << op.improving_invocations << " improving, gain = " << op.gain
+                      << ", " << op.seconds << " seconds\n";
+        }
+    }
+    #endif
+
+    return best_solution;
+
+}
+
+#endif //FILO__COREOPT_HPP_
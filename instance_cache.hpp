@@ -0,0 +1,95 @@
+#ifndef FILO__INSTANCE_CACHE_HPP_
+#define FILO__INSTANCE_CACHE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include "MappedFile.hpp"
+#include "atomic_file.hpp"
+
+// Binary cache of the instance pre-processing performed by filo (mean arc cost and greedy bound on the n. of routes),
+// so that runs on the same instance, e.g. with different seeds, skip the O(n^2) pass. Records are fixed-size and
+// stored in <cache directory>/<instance digest>.bin, where the digest covers the instance file content and the parser.
+// The same directory holds the binary conversion of the instance file, <instance digest>.instance, see instance_loader.
+namespace instance_cache {
+
+    constexpr char magic[8] = {'F', 'I', 'L', 'O', 'I', 'C', 'H', 'E'};
+    constexpr uint32_t version = 1;
+
+    struct Record {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertices_num;
+        uint64_t digest;
+        double mean_arc_cost;
+        int32_t kmin;
+        int32_t padding;
+    };
+
+    inline uint64_t get_digest(const MappedFile& instance_file, const std::string& parser) {
+        auto digest = instance_file.get_digest();
+        for (auto c : parser) {
+            digest ^= static_cast<unsigned char>(c);
+            digest *= 1099511628211ull;
+        }
+        return digest;
+    }
+
+    inline std::string get_path(const std::string& directory, uint64_t digest) {
+        auto stream = std::stringstream();
+        stream << directory << std::hex << digest << ".bin";
+        return stream.str();
+    }
+
+    // Path of the binary instance (see instance_loader) converted from the instance file with the given digest.
+    inline std::string get_instance_path(const std::string& directory, uint64_t digest) {
+        auto stream = std::stringstream();
+        stream << directory << std::hex << digest << ".instance";
+        return stream.str();
+    }
+
+    inline std::optional<Record> load(const std::string& directory, uint64_t digest, int vertices_num) {
+
+        const auto file = MappedFile(get_path(directory, digest));
+        if (!file.is_valid() || file.get_view().size() != sizeof(Record)) { return std::nullopt; }
+
+        auto record = Record();
+        std::memcpy(&record, file.get_view().data(), sizeof(Record));
+
+        if (std::memcmp(record.magic, magic, sizeof(magic)) != 0 || record.version != version ||
+            record.digest != digest || record.vertices_num != static_cast<uint32_t>(vertices_num)) {
+            return std::nullopt;
+        }
+
+        return record;
+
+    }
+
+    // Writes to a temporary file which is then renamed, so that concurrent runs never read a partial record.
+    inline bool store(const std::string& directory, uint64_t digest, int vertices_num, double mean_arc_cost, int kmin) {
+
+        auto record = Record();
+        std::memcpy(record.magic, magic, sizeof(magic));
+        record.version = version;
+        record.vertices_num = vertices_num;
+        record.digest = digest;
+        record.mean_arc_cost = mean_arc_cost;
+        record.kmin = kmin;
+        record.padding = 0;
+
+        auto error = std::error_code();
+        std::filesystem::create_directories(directory, error);
+
+        return atomic_file::write(get_path(directory, digest), std::ios::binary, [&record](std::ofstream& stream) {
+            stream.write(reinterpret_cast<const char*>(&record), sizeof(Record));
+        });
+
+    }
+
+}
+
+#endif //FILO__INSTANCE_CACHE_HPP_
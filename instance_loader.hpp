@@ -0,0 +1,314 @@
+#ifndef FILO__INSTANCE_LOADER_HPP_
+#define FILO__INSTANCE_LOADER_HPP_
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include "MappedFile.hpp"
+#include "atomic_file.hpp"
+
+// Instance parsers plugged into cobra::Instance::make<Parser, round_costs> which read the memory mapped file in place:
+// - MappedXInstanceParser reads X (TSPLIB, EUC_2D) files with a hand-written number parser, without the per-token
+//   string copies of stream based parsing;
+// - BinaryInstanceParser reads the compact binary format written by store_binary, i.e. a fixed header followed by the
+//   raw x coordinates, y coordinates and demands arrays, which any instance parsed by COBRA can be converted to.
+// Both only replace the parsing of the file: the instance itself, including its neighbor lists, is still built by COBRA.
+namespace instance_loader {
+
+    // Parsed data consumed by cobra::Instance::make, as returned by COBRA's own parsers, and the type in which they
+    // store coordinates, so that coordinates are parsed and stored without any conversion.
+    using ParserData = typename decltype(std::declval<cobra::XInstanceParser&>().parse())::value_type;
+    using Coordinate = typename decltype(ParserData::xcoords)::value_type;
+
+    constexpr char magic[8] = {'F', 'I', 'L', 'O', 'I', 'N', 'S', 'T'};
+    constexpr uint32_t version = 2;
+
+    struct BinaryHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertices_num;
+        int32_t capacity;
+        // whether the instance has been parsed with rounded costs, see cobra::Instance::make
+        uint32_t round_costs;
+        // sizeof(Coordinate) of the build which wrote the file
+        uint32_t coordinate_size;
+    };
+
+    // The only place, along with Coordinate, depending on the layout of COBRA's parser data. Any mismatch with COBRA's
+    // parsers which compiles is detected by matches(), see bench/filo_checks.cpp.
+    inline ParserData make_data(int capacity, std::vector<Coordinate>&& xcoords, std::vector<Coordinate>&& ycoords, std::vector<int>&& demands) {
+        auto data = ParserData();
+        data.capacity = capacity;
+        data.xcoords = std::move(xcoords);
+        data.ycoords = std::move(ycoords);
+        data.demands.assign(demands.begin(), demands.end());
+        return data;
+    }
+
+    // Cursor over a mapped text, parsing numbers in place.
+    class TextCursor {
+
+        const char* curr;
+        const char* const end;
+
+        static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+        static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+     public:
+
+        explicit TextCursor(std::string_view text) : curr(text.data()), end(text.data() + text.size()) { }
+
+        void skip_spaces() {
+            while (curr < end && is_space(*curr)) { curr++; }
+        }
+
+        // Next line, without the line terminator.
+        std::string_view next_line() {
+            const auto begin = curr;
+            while (curr < end && *curr != '\n') { curr++; }
+            auto line = std::string_view(begin, curr - begin);
+            if (curr < end) { curr++; }
+            if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+            return line;
+        }
+
+        std::string_view next_token() {
+            skip_spaces();
+            const auto begin = curr;
+            while (curr < end && !is_space(*curr)) { curr++; }
+            return {begin, static_cast<size_t>(curr - begin)};
+        }
+
+        bool next_int(int& value) {
+            skip_spaces();
+            const auto negative = curr < end && *curr == '-';
+            if (curr < end && (*curr == '-' || *curr == '+')) { curr++; }
+            if (curr == end || !is_digit(*curr)) { return false; }
+            auto parsed = 0l;
+            while (curr < end && is_digit(*curr)) {
+                parsed = parsed * 10 + (*curr - '0');
+                curr++;
+            }
+            value = static_cast<int>(negative ? -parsed : parsed);
+            return curr == end || is_space(*curr);
+        }
+
+        // Parses the next token as a double, correctly rounded as by std::strtod, and converts it to the coordinate type
+        // as stream based parsing of a double does.
+        bool next_coordinate(Coordinate& value) {
+            auto token = next_token();
+            if (!token.empty() && token.front() == '+') { token.remove_prefix(1); }
+            auto parsed = 0.0;
+            const auto [ptr, error] = std::from_chars(token.data(), token.data() + token.size(), parsed);
+            if (error != std::errc() || ptr != token.data() + token.size()) { return false; }
+            value = static_cast<Coordinate>(parsed);
+            return true;
+        }
+
+    };
+
+    inline std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) { text.remove_prefix(1); }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) { text.remove_suffix(1); }
+        return text;
+    }
+
+    // Parser of X (TSPLIB) instances. Only EUC_2D instances whose vertices are listed in order with the depot first are
+    // handled: parse() returns an empty optional on anything else, so that callers can fall back to cobra::XInstanceParser.
+    class MappedXInstanceParser {
+
+        const std::string path;
+
+     public:
+
+        explicit MappedXInstanceParser(std::string path_) : path(std::move(path_)) { }
+
+        std::optional<ParserData> parse() const {
+
+            const auto file = MappedFile(path);
+            if (!file.is_valid()) { return std::nullopt; }
+
+            auto cursor = TextCursor(file.get_view());
+
+            auto vertices_num = 0;
+            auto capacity = 0;
+
+            // specification part, as "KEY : VALUE" lines up to the first section
+            for (;;) {
+                const auto line = trim(cursor.next_line());
+                if (line == "NODE_COORD_SECTION") { break; }
+                if (line.empty()) { continue; }
+                const auto colon = line.find(':');
+                if (colon == std::string_view::npos) { return std::nullopt; }
+                const auto key = trim(line.substr(0, colon));
+                const auto value = trim(line.substr(colon + 1));
+                if (key == "DIMENSION") {
+                    if (!TextCursor(value).next_int(vertices_num)) { return std::nullopt; }
+                } else if (key == "CAPACITY") {
+                    if (!TextCursor(value).next_int(capacity)) { return std::nullopt; }
+                } else if (key == "EDGE_WEIGHT_TYPE" && value != "EUC_2D") {
+                    return std::nullopt;
+                }
+            }
+
+            if (vertices_num < 2 || capacity <= 0) { return std::nullopt; }
+
+            auto xcoords = std::vector<Coordinate>(vertices_num);
+            auto ycoords = std::vector<Coordinate>(vertices_num);
+            auto demands = std::vector<int>(vertices_num);
+
+            for (auto i = 0; i < vertices_num; i++) {
+                auto id = 0;
+                if (!cursor.next_int(id) || id != i + 1 || !cursor.next_coordinate(xcoords[i]) || !cursor.next_coordinate(ycoords[i])) { return std::nullopt; }
+            }
+
+            if (cursor.next_token() != "DEMAND_SECTION") { return std::nullopt; }
+            for (auto i = 0; i < vertices_num; i++) {
+                auto id = 0;
+                if (!cursor.next_int(id) || id != i + 1 || !cursor.next_int(demands[i])) { return std::nullopt; }
+            }
+
+            auto depot = 0;
+            if (cursor.next_token() != "DEPOT_SECTION" || !cursor.next_int(depot) || depot != 1) { return std::nullopt; }
+
+            return make_data(capacity, std::move(xcoords), std::move(ycoords), std::move(demands));
+
+        }
+
+    };
+
+    // Header of the binary instance in file, if it is one.
+    inline std::optional<BinaryHeader> read_binary_header(const MappedFile& file) {
+
+        if (!file.is_valid() || file.get_view().size() < sizeof(BinaryHeader)) { return std::nullopt; }
+
+        auto header = BinaryHeader();
+        std::memcpy(&header, file.get_view().data(), sizeof(BinaryHeader));
+
+        const auto expected_size = sizeof(BinaryHeader) + static_cast<size_t>(header.vertices_num) * (2 * sizeof(Coordinate) + sizeof(int32_t));
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.coordinate_size != sizeof(Coordinate) ||
+            file.get_view().size() != expected_size) {
+            return std::nullopt;
+        }
+
+        return header;
+
+    }
+
+    // Parser of binary instances written by store_binary.
+    class BinaryInstanceParser {
+
+        const std::string path;
+
+     public:
+
+        explicit BinaryInstanceParser(std::string path_) : path(std::move(path_)) { }
+
+        std::optional<ParserData> parse() const {
+
+            const auto file = MappedFile(path);
+            const auto header = read_binary_header(file);
+            if (!header) { return std::nullopt; }
+
+            const auto vertices_num = static_cast<int>(header->vertices_num);
+            auto xcoords = std::vector<Coordinate>(vertices_num);
+            auto ycoords = std::vector<Coordinate>(vertices_num);
+            auto demands = std::vector<int>(vertices_num);
+
+            auto ptr = file.get_view().data() + sizeof(BinaryHeader);
+            std::memcpy(xcoords.data(), ptr, vertices_num * sizeof(Coordinate));
+            ptr += vertices_num * sizeof(Coordinate);
+            std::memcpy(ycoords.data(), ptr, vertices_num * sizeof(Coordinate));
+            ptr += vertices_num * sizeof(Coordinate);
+            std::memcpy(demands.data(), ptr, vertices_num * sizeof(int32_t));
+
+            return make_data(header->capacity, std::move(xcoords), std::move(ycoords), std::move(demands));
+
+        }
+
+    };
+
+    // Writes instance in the binary format to a temporary file which is then renamed, so that concurrent runs never read
+    // a partial instance.
+    inline bool store_binary(const std::string& path, const cobra::Instance& instance, bool round_costs) {
+
+        const auto vertices_num = instance.get_vertices_num();
+
+        auto header = BinaryHeader();
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.vertices_num = vertices_num;
+        header.capacity = instance.get_vehicle_capacity();
+        header.round_costs = round_costs;
+        header.coordinate_size = sizeof(Coordinate);
+
+        auto xcoords = std::vector<Coordinate>(vertices_num);
+        auto ycoords = std::vector<Coordinate>(vertices_num);
+        auto demands = std::vector<int32_t>(vertices_num);
+        for (auto i = instance.get_vertices_begin(); i < instance.get_vertices_end(); i++) {
+            xcoords[i] = instance.get_x_coordinate(i);
+            ycoords[i] = instance.get_y_coordinate(i);
+            demands[i] = instance.get_demand(i);
+        }
+
+        auto error = std::error_code();
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+        return atomic_file::write(path, std::ios::binary, [&](std::ofstream& stream) {
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+            stream.write(reinterpret_cast<const char*>(xcoords.data()), vertices_num * sizeof(Coordinate));
+            stream.write(reinterpret_cast<const char*>(ycoords.data()), vertices_num * sizeof(Coordinate));
+            stream.write(reinterpret_cast<const char*>(demands.data()), vertices_num * sizeof(int32_t));
+        });
+
+    }
+
+    // Whether two instances hold the same data, field for field: vertices, capacity, coordinates, demands, arc costs
+    // and neighbor lists. Describes the first difference in error otherwise.
+    inline bool matches(const cobra::Instance& a, const cobra::Instance& b, std::string& error) {
+
+        if (a.get_vertices_num() != b.get_vertices_num()) {
+            error = "different number of vertices";
+            return false;
+        }
+        if (a.get_vehicle_capacity() != b.get_vehicle_capacity()) {
+            error = "different vehicle capacity";
+            return false;
+        }
+
+        for (auto i = a.get_vertices_begin(); i < a.get_vertices_end(); i++) {
+            if (a.get_x_coordinate(i) != b.get_x_coordinate(i) || a.get_y_coordinate(i) != b.get_y_coordinate(i)) {
+                error = "different coordinates of vertex " + std::to_string(i);
+                return false;
+            }
+            if (a.get_demand(i) != b.get_demand(i)) {
+                error = "different demand of vertex " + std::to_string(i);
+                return false;
+            }
+            if (a.get_neighbors_of(i) != b.get_neighbors_of(i)) {
+                error = "different neighbors of vertex " + std::to_string(i);
+                return false;
+            }
+            for (auto j : a.get_neighbors_of(i)) {
+                if (a.get_cost(i, j) != b.get_cost(i, j)) {
+                    error = "different cost of arc (" + std::to_string(i) + ", " + std::to_string(j) + ")";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+
+    }
+
+}
+
+#endif //FILO__INSTANCE_LOADER_HPP_
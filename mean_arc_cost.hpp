@@ -0,0 +1,100 @@
+#ifndef FILO__MEAN_ARC_COST_HPP_
+#define FILO__MEAN_ARC_COST_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cobra/Instance.hpp>
+
+namespace mean_arc_cost {
+
+    // Rows and columns of the cost matrix handled together, small enough for the coordinates of a block to stay in L1.
+    constexpr auto block_size = 256;
+
+    // Exact mean cost of the arcs (i, j), i < j. Blocks of rows are distributed dynamically among threads_num threads
+    // (0 means one per hardware thread) and each block walks the upper triangle in tiles of block_size columns. Partial
+    // sums are accumulated per block and added in block order, so the result does not depend on the number of threads.
+    inline double compute(const cobra::Instance& instance, int threads_num) {
+
+        const auto begin = instance.get_vertices_begin();
+        const auto end = instance.get_vertices_end();
+        const auto blocks_num = (instance.get_vertices_num() + block_size - 1) / block_size;
+
+        if (threads_num <= 0) {
+            threads_num = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads_num = std::min(threads_num, blocks_num);
+
+        auto partial_sums = std::vector<double>(blocks_num, 0.0);
+        auto next_block = std::atomic<int>(0);
+
+        const auto worker = [&]() {
+            for (auto block = next_block++; block < blocks_num; block = next_block++) {
+                const auto i_begin = begin + block * block_size;
+                const auto i_end = std::min(i_begin + block_size, end);
+                auto sum = 0.0;
+                for (auto j_begin = i_begin; j_begin < end; j_begin += block_size) {
+                    const auto j_end = std::min(j_begin + block_size, end);
+                    for (auto i = i_begin; i < i_end; i++) {
+                        for (auto j = std::max(i + 1, j_begin); j < j_end; j++) {
+                            sum += instance.get_cost(i, j);
+                        }
+                    }
+                }
+                partial_sums[block] = sum;
+            }
+        };
+
+        auto threads = std::vector<std::thread>();
+        for (auto t = 1; t < threads_num; t++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        auto sum = 0.0;
+        for (auto partial_sum : partial_sums) {
+            sum += partial_sum;
+        }
+
+        return sum / (instance.get_vertices_num() * (instance.get_vertices_num() - 1) / 2.0);
+
+    }
+
+    // Estimate of the mean arc cost from samples_num arcs drawn uniformly at random. Returns the estimate along with
+    // its standard error; the exact value lies within two standard errors of the estimate with approx. 95% confidence.
+    inline std::pair<double, double> estimate(const cobra::Instance& instance, int samples_num, unsigned int seed) {
+
+        auto rand_engine = std::mt19937(seed);
+        auto vertices_distribution = std::uniform_int_distribution<int>(instance.get_vertices_begin(), instance.get_vertices_end() - 1);
+
+        auto sum = 0.0;
+        auto sum_of_squares = 0.0;
+
+        for (auto n = 0; n < samples_num; n++) {
+            const auto i = vertices_distribution(rand_engine);
+            auto j = vertices_distribution(rand_engine);
+            while (j == i) {
+                j = vertices_distribution(rand_engine);
+            }
+            const auto cost = static_cast<double>(instance.get_cost(i, j));
+            sum += cost;
+            sum_of_squares += cost * cost;
+        }
+
+        const auto mean = sum / samples_num;
+        const auto variance = std::max(0.0, sum_of_squares / samples_num - mean * mean);
+
+        return {mean, std::sqrt(variance / samples_num)};
+
+    }
+
+}
+
+#endif //FILO__MEAN_ARC_COST_HPP_
@@ -0,0 +1,120 @@
+#ifndef FILO__NEIGHBOR_CACHE_HPP_
+#define FILO__NEIGHBOR_CACHE_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include "CostTable.hpp"
+#include "MappedFile.hpp"
+#include "atomic_file.hpp"
+
+// Binary cache of the cost table built by filo from the instance neighbor lists (the full matrix, or the neighbor and
+// depot costs of the sparse backend along with the outcome of its validation), so that runs on the same instance skip
+// its construction. Files are a fixed header followed by the raw float arrays, and are stored in
+// <cache directory>/<digest>.costs, where the digest covers the instance file content, the parser and the parameters
+// shaping the table. The neighbor lists and the move generators themselves are built by COBRA and are not cached.
+namespace neighbor_cache {
+
+    constexpr char magic[8] = {'F', 'I', 'L', 'O', 'N', 'B', 'C', 'H'};
+    constexpr uint32_t version = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertices_num;
+        uint64_t digest;
+        uint32_t backend;
+        uint32_t neighbors_num;
+        uint32_t euclidean;
+        uint32_t padding;
+    };
+
+    // Digest of the table built on the instance with the given digest (see instance_cache::get_digest) by
+    // CostTable(instance, round_costs, full_matrix_max_vertices, neighbors_num).
+    inline uint64_t get_digest(uint64_t instance_digest, bool round_costs, int full_matrix_max_vertices, int neighbors_num) {
+        auto digest = instance_digest;
+        for (auto value : {static_cast<int>(round_costs), full_matrix_max_vertices, neighbors_num}) {
+            for (auto n = 0; n < 4; n++) {
+                digest ^= static_cast<unsigned char>(static_cast<uint32_t>(value) >> (8 * n));
+                digest *= 1099511628211ull;
+            }
+        }
+        return digest;
+    }
+
+    inline std::string get_path(const std::string& directory, uint64_t digest) {
+        auto stream = std::stringstream();
+        stream << directory << std::hex << digest << ".costs";
+        return stream.str();
+    }
+
+    inline std::unique_ptr<CostTable> load(const std::string& directory, uint64_t digest, const cobra::Instance& instance, bool round_costs) {
+
+        const auto file = MappedFile(get_path(directory, digest));
+        if (!file.is_valid() || file.get_view().size() < sizeof(Header)) { return nullptr; }
+
+        auto header = Header();
+        std::memcpy(&header, file.get_view().data(), sizeof(Header));
+
+        const auto vertices_num = static_cast<size_t>(instance.get_vertices_num());
+        const auto backend = static_cast<CostTable::Backend>(header.backend);
+        const auto matrix_size = backend == CostTable::Backend::FULL_MATRIX ? vertices_num * vertices_num : 0;
+        const auto neighbor_costs_size = backend == CostTable::Backend::SPARSE ? vertices_num * header.neighbors_num : 0;
+        const auto depot_costs_size = backend == CostTable::Backend::SPARSE ? vertices_num : 0;
+
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version || header.digest != digest ||
+            header.vertices_num != vertices_num || header.backend > static_cast<uint32_t>(CostTable::Backend::SPARSE) ||
+            file.get_view().size() != sizeof(Header) + sizeof(float) * (matrix_size + neighbor_costs_size + depot_costs_size)) {
+            return nullptr;
+        }
+
+        auto matrix = std::vector<float>(matrix_size);
+        auto neighbor_costs = std::vector<float>(neighbor_costs_size);
+        auto depot_costs = std::vector<float>(depot_costs_size);
+
+        auto ptr = file.get_view().data() + sizeof(Header);
+        std::memcpy(matrix.data(), ptr, sizeof(float) * matrix_size);
+        ptr += sizeof(float) * matrix_size;
+        std::memcpy(neighbor_costs.data(), ptr, sizeof(float) * neighbor_costs_size);
+        ptr += sizeof(float) * neighbor_costs_size;
+        std::memcpy(depot_costs.data(), ptr, sizeof(float) * depot_costs_size);
+
+        return std::make_unique<CostTable>(instance, round_costs, backend, static_cast<int>(header.neighbors_num), std::move(matrix),
+                                           std::move(neighbor_costs), std::move(depot_costs), header.euclidean != 0);
+
+    }
+
+    // Writes to a temporary file which is then renamed, so that concurrent runs never read a partial table.
+    inline bool store(const std::string& directory, uint64_t digest, const cobra::Instance& instance, const CostTable& costs) {
+
+        auto header = Header();
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = version;
+        header.vertices_num = instance.get_vertices_num();
+        header.digest = digest;
+        header.backend = static_cast<uint32_t>(costs.get_backend());
+        header.neighbors_num = costs.get_neighbors_num();
+        header.euclidean = costs.is_euclidean();
+        header.padding = 0;
+
+        auto error = std::error_code();
+        std::filesystem::create_directories(directory, error);
+
+        return atomic_file::write(get_path(directory, digest), std::ios::binary, [&header, &costs](std::ofstream& stream) {
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            for (const auto* array : {&costs.get_matrix(), &costs.get_neighbor_costs(), &costs.get_depot_costs()}) {
+                stream.write(reinterpret_cast<const char*>(array->data()), static_cast<std::streamsize>(sizeof(float) * array->size()));
+            }
+        });
+
+    }
+
+}
+
+#endif //FILO__NEIGHBOR_CACHE_HPP_
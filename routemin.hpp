@@ -2,36 +2,188 @@
 // Created by acco on 10/15/19.
 //
 
+#ifndef FILO__ROUTEMIN_HPP_
+#define FILO__ROUTEMIN_HPP_
 
 #include <iostream>
-#include <unordered_set>
 #include <cobra/Solution.hpp>
 #include <cobra/MoveGenerators.hpp>
 #include <chrono>
 #include <cobra/LocalSearch.hpp>
 #include <iomanip>
 #include <cobra/PrettyPrinter.hpp>
+#include <memory>
+#include "BestInsertion.hpp"
+#include "CostTable.hpp"
+#include "MeasuredNeighborhoodDescent.hpp"
+#include "RouteRestorer.hpp"
+#include "WorkerThreads.hpp"
+#include "allocation_counter.hpp"
+
+// Route elimination attempt of ROUTEMIN: the routes of a seed customer and of its closest different route are removed,
+// their customers are reinserted and a local search is applied. Parallel ROUTEMIN runs one worker per thread.
+class RouteminWorker {
+
+    const cobra::Instance& instance;
+    std::mt19937& rand_engine;
+    std::unique_ptr<cobra::VariableNeighborhoodDescentInterface> rvnd0;
+    cobra::HierarchicalVariableNeighborhoodDescent local_search;
+    BestInsertion insertion;
+    std::uniform_real_distribution<float> uniform_01_dist;
+
+    std::vector<int> removed;
+    std::vector<int> selected_routes;
+
+ public:
+
+    #ifdef ALLOCATION_COUNTER
+    unsigned long reinsertion_allocations = 0ul;
+    #endif
+
+    RouteminWorker(const cobra::Instance& instance_, const CostTable& costs, cobra::MoveGenerators& move_generators, std::mt19937& rand_engine_, float tolerance,
+                   bool flat_routes, bool adaptive_operators) :
+        instance(instance_),
+        rand_engine(rand_engine_),
+        local_search(tolerance),
+        insertion(instance, costs, flat_routes),
+        uniform_01_dist(0.0f, 1.0f) {
+
+        const auto operators = std::vector<cobra::Operator>{
+            cobra::E11,cobra::E10,cobra::TAILS,cobra::SPLIT,cobra::RE22B,
+            cobra::E22,cobra::RE20,cobra::RE21,cobra::RE22S,cobra::E21,
+            cobra::E20,cobra::TWOPT,cobra::RE30,cobra::E30,cobra::RE33B,
+            cobra::E33,cobra::RE31,cobra::RE32B,cobra::RE33S,cobra::E31,
+            cobra::E32,cobra::RE32S};
+        if (adaptive_operators) {
+            rvnd0 = std::make_unique<MeasuredNeighborhoodDescent<true>>(instance, move_generators, operators, rand_engine, tolerance, true);
+        } else {
+            rvnd0 = std::make_unique<cobra::RandomizedVariableNeighborhoodDescent<true>>(instance, move_generators, operators, rand_engine, tolerance);
+        }
+
+        local_search.append(rvnd0.get());
+
+        removed.reserve(instance.get_customers_num());
+        selected_routes.reserve(2);
+
+    }
+
+    // Customers which cannot be inserted into existing routes open a new route with probability 1 - t (or if solution
+    // has less than kmin routes), otherwise they are kept aside in still_removed until the next attempt. The cache of
+    // solution is cleared first, hence it then holds the vertices touched by the attempt.
+    void attempt(cobra::Solution& solution, std::vector<int>& still_removed, int seed, float t, int kmin) {
+
+        solution.clear_cache();
+
+        #ifdef ALLOCATION_COUNTER
+        const auto reinsertion_allocations_begin = allocation_counter::get();
+        #endif
+
+        remove_routes(solution, still_removed, seed);
+        reinsert(solution, still_removed, t, kmin);
+
+        #ifdef ALLOCATION_COUNTER
+        reinsertion_allocations += allocation_counter::get() - reinsertion_allocations_begin;
+        #endif
+
+        local_search.apply(solution);
+
+    }
+
+    // Removes the routes of seed and of its closest different route, and queues their customers, along with those in
+    // still_removed, for reinsertion.
+    void remove_routes(cobra::Solution& solution, std::vector<int>& still_removed, int seed) {
+
+        // Remove all customers from the selected route and remove the route itself
+
+        selected_routes.clear();
+        selected_routes.push_back(solution.get_route_index(seed));
+        const auto& neighbors = instance.get_neighbors_of(seed);
+
+
+        for(auto n = 1u; n < neighbors.size(); n++) {
+            const auto vertex = neighbors[n];
+            if(vertex == instance.get_depot()) { continue; }
+            if(!solution.is_customer_in_solution(vertex)) { continue; }
+            const auto route = solution.get_route_index(vertex);
+            if(route != selected_routes[0]) {
+                selected_routes.push_back(route);
+                break;
+            }
+        }
+
+        removed.clear();
+        removed.insert(removed.end(), still_removed.begin(), still_removed.end());
+        still_removed.clear();
+
+        for(auto selected_route : selected_routes) {
+
+            auto curr = solution.get_first_customer(selected_route);
+            do {
+                const auto next = solution.get_next_vertex(curr);
+                solution.remove_vertex(selected_route, curr);
+                removed.emplace_back(curr);
+                curr = next;
+            } while (curr!=instance.get_depot());
+
+            solution.remove_route(selected_route);
+
+        }
+
+        if (rand_engine() % 2 == 0) {
+            std::sort(removed.begin(), removed.end(),[this](auto i, auto j) { return instance.get_demand(i) > instance.get_demand(j); });
+        } else {
+            std::shuffle(removed.begin(), removed.end(), rand_engine);
+        }
+
+    }
+
+    // Reinserts the customers queued by remove_routes, see attempt.
+    void reinsert(cobra::Solution& solution, std::vector<int>& still_removed, float t, int kmin) {
+
+        insertion.invalidate();
+
+        for (auto i : removed) {
 
-cobra::Solution routemin(const cobra::Instance &instance,
-                         const cobra::Solution &source, std::mt19937 &rand_engine,
-                         cobra::MoveGenerators& move_generators,
-                         int kmin, int max_iter, float tolerance) {
+            const auto best = insertion.find_best(solution, i);
+
+            if (best.route == cobra::Solution::dummy_route) {
+
+                const auto r = uniform_01_dist(rand_engine);
+
+                if(r > t || solution.get_routes_num() < kmin) {
+                    solution.build_one_customer_route(i);
+                    insertion.invalidate(solution.get_route_index(i));
+                } else {
+                    still_removed.push_back(i);
+                }
+
+
+            } else {
+                solution.insert_vertex_before(best.route, best.where, i);
+                insertion.invalidate(best.route);
+            }
+
+        }
+
+    }
+
+};
+
+inline cobra::Solution routemin(const cobra::Instance &instance, const CostTable& costs,
+                                const cobra::Solution &source, std::mt19937 &rand_engine,
+                                cobra::MoveGenerators& move_generators, std::vector<cobra::AbstractMoveGeneratorsView*>& views,
+                                int kmin, int max_iter, float tolerance, int solution_cache_size, bool round_costs, int max_stagnation = 0, double time_limit = 0.0, int threads_num = 1,
+                                bool flat_routes = false, bool adaptive_operators = false) {
+
+    // ROUTEMIN also stops after max_stagnation iterations without reducing the n. of routes and after time_limit seconds
+    // (both disabled when non positive), so that the remaining budget is left to COREOPT
+    const auto routemin_time_begin = std::chrono::high_resolution_clock::now();
 
     #ifdef VERBOSE
     auto partial_time_begin = std::chrono::high_resolution_clock::now();
     auto partial_time_end = std::chrono::high_resolution_clock::now();
     #endif
 
-    auto rvnd0 = cobra::RandomizedVariableNeighborhoodDescent<true>(instance, move_generators, {
-        cobra::E11,cobra::E10,cobra::TAILS,cobra::SPLIT,cobra::RE22B,
-        cobra::E22,cobra::RE20,cobra::RE21,cobra::RE22S,cobra::E21,
-        cobra::E20,cobra::TWOPT,cobra::RE30,cobra::E30,cobra::RE33B,
-        cobra::E33,cobra::RE31,cobra::RE32B,cobra::RE33S,cobra::E31,
-        cobra::E32,cobra::RE32S}, rand_engine, tolerance);
-
-    auto local_search = cobra::HierarchicalVariableNeighborhoodDescent(tolerance);
-    local_search.append(&rvnd0);
-
     auto gamma_vertices = std::vector<int>();
     auto gamma = std::vector<float>(instance.get_vertices_num(), 1.0f);
     for(auto i = instance.get_vertices_begin(); i < instance.get_vertices_end(); i++) {
@@ -41,7 +193,6 @@ cobra::Solution routemin(const cobra::Instance &instance,
 
     auto best_solution = source;
 
-    auto uniform_01_dist = std::uniform_real_distribution<float>(0.0f, 1.0f);
     auto customers_distribution = std::uniform_int_distribution(instance.get_customers_begin(), instance.get_customers_end() - 1);
 
     const auto t_base = 1.00f;
@@ -49,16 +200,50 @@ cobra::Solution routemin(const cobra::Instance &instance,
     auto t = t_base;
     auto c = std::pow(t_end / t_base, 1.0 / max_iter);
 
-    auto removed = std::vector<int>();
-    removed.reserve(instance.get_customers_num());
-
     auto still_removed = std::vector<int>();
     still_removed.reserve(instance.get_customers_num());
 
+    // Workers other than the first one own their random engine and move generators, the first one shares those of the
+    // caller and, when running alone, works directly on solution
+    threads_num = std::max(1, threads_num);
+
+    auto worker_rand_engines = std::vector<std::unique_ptr<std::mt19937>>();
+    auto worker_move_generators = std::vector<std::unique_ptr<cobra::MoveGenerators>>();
+    auto workers = std::vector<std::unique_ptr<RouteminWorker>>();
+
+    workers.emplace_back(std::make_unique<RouteminWorker>(instance, costs, move_generators, rand_engine, tolerance, flat_routes, adaptive_operators));
+    for(auto w = 1; w < threads_num; w++) {
+        worker_rand_engines.emplace_back(std::make_unique<std::mt19937>(rand_engine()));
+        worker_move_generators.emplace_back(std::make_unique<cobra::MoveGenerators>(instance, views));
+        worker_move_generators.back()->set_active_percentage(gamma, gamma_vertices);
+        workers.emplace_back(std::make_unique<RouteminWorker>(instance, costs, *worker_move_generators.back(), *worker_rand_engines.back(), tolerance, flat_routes,
+                                                              adaptive_operators));
+    }
+
+    // seed customers, solutions and customers kept aside by the workers during a parallel iteration. The solutions of
+    // the workers other than the first one are kept equal to solution in between iterations by copying the routes
+    // touched by any attempt, which the caches of all the solutions record, or whole when a cache has evicted vertices
+    // or solution has been reset to the best solution
+    auto seeds = std::vector<int>(threads_num);
+    auto worker_solutions = std::vector<cobra::Solution>(threads_num - 1, source);
+    auto worker_still_removed = std::vector<std::vector<int>>(threads_num - 1);
+    auto worker_solutions_current = true;
+    auto touched_vertices = std::vector<int>();
+    auto route_restorer = RouteRestorer(instance, std::min(instance.get_vertices_num(), solution_cache_size), round_costs);
+
     auto solution = best_solution;
 
     solution.clear_cache();
 
+    // the threads of the workers other than the first one are started once and wait for the next parallel iteration
+    auto worker_threads = WorkerThreads(threads_num, [&](int w) {
+        if (w == 0) {
+            workers[0]->attempt(solution, still_removed, seeds[0], t, kmin);
+        } else {
+            workers[w]->attempt(worker_solutions[w - 1], worker_still_removed[w - 1], seeds[w], t, kmin);
+        }
+    });
+
     #ifdef VERBOSE
     const auto main_opt_loop_begin_time = std::chrono::high_resolution_clock::now();
 
@@ -76,7 +261,20 @@ cobra::Solution routemin(const cobra::Instance &instance,
     #endif
 
 
-    for(auto iter=0; iter < max_iter; iter++) {
+    // iterations which reduced the n. of routes of the best solution
+    auto improving_iterations = 0;
+    auto last_improving_iter = 0;
+    auto iter = 0;
+
+    for(; iter < max_iter; iter++) {
+
+        if(max_stagnation > 0 && iter - last_improving_iter >= max_stagnation) {
+            break;
+        }
+
+        if(time_limit > 0.0 && std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - routemin_time_begin).count() >= time_limit) {
+            break;
+        }
 
         #ifdef VERBOSE
         partial_time_end = std::chrono::high_resolution_clock::now();
@@ -103,121 +301,103 @@ cobra::Solution routemin(const cobra::Instance &instance,
         }
 #endif
 
-        // Remove all customers from the selected route and remove the route itself
-        
-        auto seed = cobra::Solution::dummy_vertex;
-        do{
-            seed = customers_distribution(rand_engine);
-        }while(!solution.is_customer_in_solution(seed));
-        auto selected_routes = std::vector<int>();
-        selected_routes.push_back(solution.get_route_index(seed));
-        const auto& neighbors = instance.get_neighbors_of(seed);
-
+        if(threads_num == 1) {
 
-        for(auto n = 1u; n < neighbors.size(); n++) {
-            const auto vertex = neighbors[n];
-            if(vertex == instance.get_depot()) { continue; }
-            if(!solution.is_customer_in_solution(vertex)) { continue; }
-            const auto route = solution.get_route_index(vertex);
-            if(route != selected_routes[0]) {
-                selected_routes.push_back(route);
-                break;
-            }
-        }
-
-        removed.clear();
-        removed.insert(removed.end(), still_removed.begin(), still_removed.end());
-        still_removed.clear();
-
-        for(auto selected_route : selected_routes) {
-
-            auto curr = solution.get_first_customer(selected_route);
-            do {
-                const auto next = solution.get_next_vertex(curr);
-                solution.remove_vertex(selected_route, curr);
-                removed.emplace_back(curr);
-                curr = next;
-            } while (curr!=instance.get_depot());
-
-            solution.remove_route(selected_route);
+            auto seed = cobra::Solution::dummy_vertex;
+            do{
+                seed = customers_distribution(rand_engine);
+            }while(!solution.is_customer_in_solution(seed));
 
-        }
+            workers[0]->attempt(solution, still_removed, seed, t, kmin);
 
-        if (rand_engine() % 2 == 0) {
-            std::sort(removed.begin(), removed.end(),[&instance](auto i, auto j) { return instance.get_demand(i) > instance.get_demand(j); });
         } else {
-            std::shuffle(removed.begin(), removed.end(), rand_engine);
-        }
-
 
-        for (auto i : removed) {
-
-            auto best_route = -1;
-            auto best_where = -1;
-            auto best_delta = std::numeric_limits<float>::max();
-
-            for (auto route = solution.get_first_route();
-                 route != cobra::Solution::dummy_route; route = solution.get_next_route(route)) {
-
-                if (solution.get_route_load(route) + instance.get_demand(i) > instance.get_vehicle_capacity()) {
-                    continue;
+            // Each worker tries to eliminate a different route, the first one on solution and the others on a copy
+            for(auto w = 0; w < threads_num; w++) {
+                auto draws = 0;
+                do{
+                    seeds[w] = customers_distribution(rand_engine);
+                    if(!solution.is_customer_in_solution(seeds[w])) { continue; }
+                    draws++;
+                    const auto route = solution.get_route_index(seeds[w]);
+                    const auto already_selected = std::any_of(seeds.begin(), seeds.begin() + w, [&solution, route](auto other) {
+                        return solution.get_route_index(other) == route;
+                    });
+                    if(!already_selected || draws >= threads_num) { break; }
+                }while(true);
+            }
+            for(auto w = 1; w < threads_num; w++) {
+                if(!worker_solutions_current) {
+                    worker_solutions[w - 1] = solution;
                 }
+                worker_still_removed[w - 1] = still_removed;
+            }
 
-                // before each customer
-                for (auto j = solution.get_first_customer(route); j != instance.get_depot(); j = solution.get_next_vertex(j)) {
-                    const auto prev = solution.get_prev_vertex(route, j);
-                    const auto delta = -instance.get_cost(prev, j) + instance.get_cost(prev, i) + instance.get_cost(i, j);
+            worker_threads.run_step();
 
-                    if (delta < best_delta) {
-                        best_route = route;
-                        best_where = j;
-                        best_delta = delta;
-                    }
+            // Accept the first feasible attempt which reduced the n. of routes of the best solution, otherwise the
+            // cheapest feasible attempt, otherwise the one of the first worker
+            const auto is_feasible = [&](int w) { return w == 0 ? still_removed.empty() : worker_still_removed[w - 1].empty(); };
+            const auto get_solution = [&](int w) -> const cobra::Solution& { return w == 0 ? solution : worker_solutions[w - 1]; };
 
+            auto accepted = -1;
+            for(auto w = 0; w < threads_num && accepted < 0; w++) {
+                if(is_feasible(w) && get_solution(w).get_routes_num() < best_solution.get_routes_num()) {
+                    accepted = w;
                 }
-
-                // before the depot
-                const auto delta = -instance.get_cost(solution.get_last_customer(route), instance.get_depot())
-                                   + instance.get_cost(solution.get_last_customer(route), i)
-                                   + instance.get_cost(i, instance.get_depot());
-
-                if (delta < best_delta) {
-                    best_route = route;
-                    best_where = instance.get_depot();
-                    best_delta = delta;
+            }
+            for(auto w = 0; w < threads_num; w++) {
+                if(!is_feasible(w)) { continue; }
+                if(accepted < 0 || (get_solution(accepted).get_routes_num() >= best_solution.get_routes_num() &&
+                                    get_solution(w).get_cost() < get_solution(accepted).get_cost())) {
+                    accepted = w;
                 }
-
-
             }
 
-            if (best_route == -1) {
-
-                const auto r = uniform_01_dist(rand_engine);
+            // all the solutions differ from each other in the routes of the vertices touched by any attempt only
+            touched_vertices.clear();
+            auto restore_routes = true;
+            for(auto w = 0; w < threads_num; w++) {
+                const auto& cache = get_solution(w).get_cache();
+                restore_routes = restore_routes && route_restorer.is_complete(cache);
+                for(auto i = cache.begin(); i != cobra::LRUCache::Entry::dummy_vertex; i = cache.get_next(i)) {
+                    touched_vertices.push_back(i);
+                }
+            }
 
-                if(r > t || solution.get_routes_num() < kmin) {
-                    solution.build_one_customer_route(i);
+            if(accepted > 0) {
+                if(restore_routes) {
+                    route_restorer.restore(solution, worker_solutions[accepted - 1], touched_vertices);
                 } else {
-                    still_removed.push_back(i);
+                    solution = worker_solutions[accepted - 1];
                 }
+                still_removed = worker_still_removed[accepted - 1];
+            }
 
-
-            } else {
-                solution.insert_vertex_before(best_route, best_where, i);
+            if(restore_routes) {
+                for(auto w = 1; w < threads_num; w++) {
+                    if(w != accepted) {
+                        route_restorer.restore(worker_solutions[w - 1], solution, touched_vertices);
+                    }
+                }
             }
+            worker_solutions_current = restore_routes;
 
         }
 
-        local_search.apply(solution);
-
-        solution.clear_cache();
-
         if(still_removed.empty()) {
 
             if(solution.get_cost() < best_solution.get_cost() || (solution.get_cost() == best_solution.get_cost() && solution.get_routes_num() < best_solution.get_routes_num())) {
 
+                if(solution.get_routes_num() < best_solution.get_routes_num()) {
+                    improving_iterations++;
+                    last_improving_iter = iter;
+                }
+
                 best_solution = solution;
 
                 if(best_solution.get_routes_num() <= kmin) {
+                    iter++;
                     goto end;
                 }
 
@@ -236,6 +416,7 @@ cobra::Solution routemin(const cobra::Instance &instance,
 
             solution = best_solution;
             still_removed.clear();
+            worker_solutions_current = false;
 
         }
 
@@ -247,8 +428,24 @@ cobra::Solution routemin(const cobra::Instance &instance,
 
     end:
 
+    #ifdef VERBOSE
+    std::cout << "ROUTEMIN stopped after " << iter << " iterations, " << improving_iterations << " of them reduced the n. of routes.\n";
+    #endif
+
+    #ifdef ALLOCATION_COUNTER
+    auto reinsertion_allocations = 0ul;
+    for(const auto& worker : workers) {
+        reinsertion_allocations += worker->reinsertion_allocations;
+    }
+    std::cout << "Heap allocations during ROUTEMIN route removal and reinsertion: " << reinsertion_allocations << ".\n";
+    #endif
+
     assert(best_solution.is_feasible());
 
+    best_solution.clear_cache();
+
     return best_solution;
 
 }
+
+#endif //FILO__ROUTEMIN_HPP_
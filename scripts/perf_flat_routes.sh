@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# Compares hardware cache counters of runs with and without the flat route layout used when reinserting customers.
+# Usage: perf_flat_routes.sh <path-to-instance> [additional filo options]
+# Both runs use the same seed and produce the same solution, only counters and runtime should differ.
+# The flat layout is disabled by default until these runs show a gain with identical results for equal seeds.
+
+path_to_filo=/home/acco/git/filo
+executable=${path_to_filo}/build/filo
+
+instance=$1
+shift
+
+events=cycles,instructions,cache-references,cache-misses,L1-dcache-loads,L1-dcache-load-misses
+
+for flat_routes in 0 1; do
+	echo "--flat-routes ${flat_routes}"
+	perf stat -e ${events} ${executable} ${instance} --flat-routes ${flat_routes} --outpath results/perf-flat-routes-${flat_routes}/ "$@"
+done
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# Compares COREOPT iterations per second and solution quality of the exhaustive recreate scan (--recreate-neighbors 0)
+# against the neighbor-driven insertion, on the filo_bench instances with the same seeds and iteration budgets.
+# Usage: perf_recreate_neighbors.sh <path-to-instances> [neighbors (default: 25)] [additional filo options]
+# The second run is compared against the first one, see results/perf-recreate-neighbors-<neighbors>/comparison.csv.
+
+path_to_filo=/home/acco/git/filo
+executable=${path_to_filo}/build/filo_bench
+
+instances=$1
+shift
+
+neighbors=25
+if [ $# -gt 0 ]; then
+	neighbors=$1
+	shift
+fi
+
+baseline_outpath=results/perf-recreate-neighbors-0/
+
+echo "--recreate-neighbors 0"
+${executable} ${instances} --outpath ${baseline_outpath} --recreate-neighbors 0 "$@" || exit 1
+
+echo "--recreate-neighbors ${neighbors}"
+${executable} ${instances} --outpath results/perf-recreate-neighbors-${neighbors}/ --recreate-neighbors ${neighbors} --baseline ${baseline_outpath}bench.csv "$@"
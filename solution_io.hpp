@@ -0,0 +1,141 @@
+#ifndef FILO__SOLUTION_IO_HPP_
+#define FILO__SOLUTION_IO_HPP_
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cobra/Instance.hpp>
+#include <cobra/Solution.hpp>
+#include "atomic_file.hpp"
+
+// Reading and writing of solutions in the .vrp.sol format produced by cobra::Solution::store_to_file, i.e. one
+// "Route #k: c1 c2 ..." line per route listing customers by vertex index, followed by a "Cost X" line.
+namespace solution_io {
+
+    // Parses a "Route #k: c1 c2 ..." line into customers. Returns false if line is not a route line.
+    inline bool parse_route(const std::string& line, std::vector<int>& customers) {
+
+        customers.clear();
+
+        if (line.rfind("Route #", 0) != 0) { return false; }
+
+        const auto separator = line.find(':');
+        if (separator == std::string::npos) { return false; }
+
+        auto stream = std::istringstream(line.substr(separator + 1));
+        for (auto customer = 0; stream >> customer;) {
+            customers.emplace_back(customer);
+        }
+
+        return stream.eof();
+
+    }
+
+    // Builds in solution, which must be empty, the given routes. Returns false, describing the reason in error, if the
+    // routes do not define a feasible solution, i.e. if a customer is unknown, missing or repeated, or if a route
+    // exceeds the vehicle capacity.
+    inline bool build(const cobra::Instance& instance, const std::vector<std::vector<int>>& routes, cobra::Solution& solution, std::string& error) {
+
+        auto visited = std::vector<bool>(instance.get_vertices_num(), false);
+
+        for (auto r = 0u; r < routes.size(); r++) {
+
+            if (routes[r].empty()) {
+                error = "route #" + std::to_string(r + 1) + " is empty";
+                return false;
+            }
+
+            auto load = 0;
+            for (auto customer : routes[r]) {
+                if (customer < instance.get_customers_begin() || customer >= instance.get_customers_end()) {
+                    error = "unknown customer " + std::to_string(customer) + " in route #" + std::to_string(r + 1);
+                    return false;
+                }
+                if (visited[customer]) {
+                    error = "customer " + std::to_string(customer) + " is served more than once";
+                    return false;
+                }
+                visited[customer] = true;
+                load += instance.get_demand(customer);
+            }
+
+            if (load > instance.get_vehicle_capacity()) {
+                error = "route #" + std::to_string(r + 1) + " has load " + std::to_string(load) + " exceeding the vehicle capacity " +
+                        std::to_string(instance.get_vehicle_capacity());
+                return false;
+            }
+
+        }
+
+        for (auto i = instance.get_customers_begin(); i < instance.get_customers_end(); i++) {
+            if (!visited[i]) {
+                error = "customer " + std::to_string(i) + " is not served";
+                return false;
+            }
+        }
+
+        const auto depot = instance.get_depot();
+        for (const auto& customers : routes) {
+            const auto route = solution.build_one_customer_route(customers[0]);
+            for (auto n = 1u; n < customers.size(); n++) {
+                solution.insert_vertex_before(route, depot, customers[n]);
+            }
+        }
+
+        return true;
+
+    }
+
+    // Writes one "Route #k: c1 c2 ..." line per route of solution.
+    inline void write_routes(std::ostream& stream, const cobra::Instance& instance, const cobra::Solution& solution) {
+        auto k = 1;
+        for (auto route = solution.get_first_route(); route != cobra::Solution::dummy_route; route = solution.get_next_route(route)) {
+            stream << "Route #" << k++ << ":";
+            for (auto curr = solution.get_first_customer(route); curr != instance.get_depot(); curr = solution.get_next_vertex(curr)) {
+                stream << " " << curr;
+            }
+            stream << "\n";
+        }
+    }
+
+    // Loads into solution, which must be empty, the solution stored in path. Returns false, describing the reason in
+    // error, if the file cannot be read or the solution is not feasible.
+    inline bool load(const cobra::Instance& instance, const std::string& path, cobra::Solution& solution, std::string& error) {
+
+        auto stream = std::ifstream(path);
+        if (!stream) {
+            error = "unable to open the file";
+            return false;
+        }
+
+        auto routes = std::vector<std::vector<int>>();
+        auto customers = std::vector<int>();
+        for (auto line = std::string(); std::getline(stream, line);) {
+            if (parse_route(line, customers)) {
+                routes.emplace_back(customers);
+            } else if (line.rfind("Route #", 0) == 0) {
+                error = "malformed line '" + line + "'";
+                return false;
+            }
+        }
+
+        return build(instance, routes, solution, error);
+
+    }
+
+    // Writes to a temporary file which is then renamed, so that readers of path always find a complete solution.
+    inline bool store(const cobra::Instance& instance, const cobra::Solution& solution, const std::string& path) {
+
+        const auto tmp_path = atomic_file::get_temporary_path(path);
+
+        cobra::Solution::store_to_file(instance, solution, tmp_path);
+
+        return atomic_file::commit(tmp_path, path);
+
+    }
+
+}
+
+#endif //FILO__SOLUTION_IO_HPP_